@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) { SetPoolSize(num_frames); }
+
+void ARCReplacer::SetPoolSize(size_t pool_size) {
+  frames_.Grow(pool_size);
+  c_ = pool_size;
+  p_ = std::min(p_, c_);
+}
+
+void ARCReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  frame.ref_ = false;
+  frame.page_id_ = page_id;
+
+  auto ghost = ghosts_.find(page_id);
+  if (ghost == ghosts_.end()) {
+    // A page seen for the first time. Keep T1 and B1 within c pages, and the whole directory within 2c.
+    if (t1_.size() + b1_.size() >= c_) {
+      while (!b1_.empty() && t1_.size() + b1_.size() >= c_) {
+        DropGhost(false);
+      }
+    } else {
+      while (!b2_.empty() && t1_.size() + t2_.size() + b1_.size() + b2_.size() >= 2 * c_) {
+        DropGhost(true);
+      }
+    }
+    frame.in_t2_ = false;
+    frame.position_ = t1_.insert(t1_.end(), frame_id);
+    return;
+  }
+
+  // A page evicted recently: the list it was evicted from should have been larger.
+  if (ghost->second.in_b2_) {
+    p_ -= std::min(p_, std::max<size_t>(1, b1_.size() / b2_.size()));
+    b2_.erase(ghost->second.position_);
+  } else {
+    p_ = std::min(c_, p_ + std::max<size_t>(1, b2_.size() / b1_.size()));
+    b1_.erase(ghost->second.position_);
+  }
+  ghosts_.erase(ghost);
+  frame.in_t2_ = true;
+  frame.position_ = t2_.insert(t2_.end(), frame_id);
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id) {
+  Frame &frame = frames_[frame_id];
+  if (!frame.ref_.load(std::memory_order_relaxed)) {
+    frame.ref_.store(true, std::memory_order_relaxed);
+  }
+}
+
+auto ARCReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  // Every step either moves a page from T1 to T2 or clears a reference bit, unless the page is pinned: a few turns
+  // are enough. Pinned pages may keep the hands going around, then take any unpinned page.
+  const size_t max_steps = 3 * (t1_.size() + t2_.size()) + 1;
+  for (size_t steps = 0; steps < max_steps; steps++) {
+    if (t1_.empty() && t2_.empty()) {
+      return -1;
+    }
+    const bool from_t1 = !t1_.empty() && (t1_.size() >= std::max<size_t>(1, p_) || t2_.empty());
+    auto &clock = from_t1 ? t1_ : t2_;
+    frame_id_t frame_id = clock.front();
+    Frame &frame = frames_[frame_id];
+    if (frame.ref_.exchange(false)) {
+      // Seen again: a page of T1 moves on to T2, a page of T2 goes around once more.
+      frame.in_t2_ = true;
+      t2_.splice(t2_.end(), clock, clock.begin());
+      continue;
+    }
+    if (evictable(frame_id)) {
+      return frame_id;
+    }
+    clock.splice(clock.end(), clock, clock.begin());
+  }
+  for (auto *clock : {&t1_, &t2_}) {
+    for (frame_id_t frame_id : *clock) {
+      if (evictable(frame_id)) {
+        return frame_id;
+      }
+    }
+  }
+  return -1;
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id, bool evicted) {
+  Frame &frame = frames_[frame_id];
+  (frame.in_t2_ ? t2_ : t1_).erase(frame.position_);
+  if (!evicted) {
+    return;
+  }
+  auto &ghosts = frame.in_t2_ ? b2_ : b1_;
+  ghosts_[frame.page_id_] = Ghost{frame.in_t2_, ghosts.insert(ghosts.end(), frame.page_id_)};
+}
+
+void ARCReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  for (auto *clock : {&t1_, &t2_}) {
+    for (frame_id_t frame_id : *clock) {
+      if (!visit(frame_id)) {
+        return;
+      }
+    }
+  }
+}
+
+void ARCReplacer::DropGhost(bool from_b2) {
+  auto &ghosts = from_b2 ? b2_ : b1_;
+  ghosts_.erase(ghosts.front());
+  ghosts.pop_front();
+}
+
+}  // namespace bustub
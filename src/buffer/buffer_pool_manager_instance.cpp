@@ -10,7 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <new>
 #include <set>
+#include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager_instance.h"
 
 #include "common/exception.h"
@@ -18,224 +29,302 @@
 
 namespace bustub {
 
-BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
+namespace {
+
+/** The size of a transparent huge page on x86-64 and on arm64 with 4 KB pages. */
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+/** The frame data of the largest buffer pool. */
+constexpr size_t FRAME_DATA_SIZE = static_cast<size_t>(BUFFER_POOL_MAX_FRAMES) * BUSTUB_PAGE_SIZE;
+/** The frame data and the slack to align it on a huge page. */
+constexpr size_t FRAME_ARENA_SIZE = FRAME_DATA_SIZE + HUGE_PAGE_SIZE;
+
+/** Run a disk I/O and add the time it took to a counter, in microseconds. */
+template <class IO>
+void TimeIo(std::atomic<uint64_t> *counter, IO &&io) {
+  auto start = std::chrono::steady_clock::now();
+  io();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  counter->fetch_add(elapsed.count(), std::memory_order_relaxed);
+}
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    pages_[i].k_ = replacer_k;
-    free_list_.emplace_back(static_cast<frame_id_t>(i));
-  }
+}  // namespace
 
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(0),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      disk_scheduler_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size),
+      replacer_(CreateReplacer(replacer_type, replacer_k)) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  BUSTUB_ASSERT(pool_size > 0 && pool_size <= BUFFER_POOL_MAX_FRAMES, "invalid buffer pool size");
+  // we reserve a consecutive memory space for the largest buffer pool, frames are only set up as the pool grows
+  void *frames = mmap(nullptr, BUFFER_POOL_MAX_FRAMES * sizeof(Page), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (frames == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot reserve the buffer pool frames");
+  }
+  pages_ = static_cast<Page *>(frames);
+  void *arena = mmap(nullptr, FRAME_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1,
+                     0);
+  if (arena == MAP_FAILED) {
+    munmap(pages_, BUFFER_POOL_MAX_FRAMES * sizeof(Page));
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot reserve the buffer pool memory");
+  }
+  frame_arena_ = static_cast<char *>(arena);
+  frame_data_ = frame_arena_ + (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(frame_arena_) % HUGE_PAGE_SIZE) %
+                                   HUGE_PAGE_SIZE;
+#ifdef MADV_HUGEPAGE
+  // Only a hint, transparent huge pages may be disabled.
+  madvise(frame_data_, FRAME_DATA_SIZE, MADV_HUGEPAGE);
+#endif
+
+  std::scoped_lock lock(mutex_);
+  AddFrames(pool_size);
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
-  delete page_table_;
+  StopPageCleaner();
+  {
+    std::scoped_lock lock(mutex_);
+    enable_prefetcher_ = false;
+  }
+  if (prefetch_thread_ != nullptr) {
+    prefetch_cv_.notify_all();
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  for (size_t i = 0; i < num_frames_; i++) {
+    pages_[i].~Page();
+  }
+  munmap(pages_, BUFFER_POOL_MAX_FRAMES * sizeof(Page));
+  munmap(frame_arena_, FRAME_ARENA_SIZE);
 }
 
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  frame_id_t frame_id;
-
-  Page *page;
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, page_id_t segment) -> Page * {
   std::unique_lock lock(mutex_);
-  // free_list_latch_.WLock();
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
- // std::cout << "NewPgImp pop frame_id=" << frame_id << std::endl;
-    free_list_.pop_front();
-    page = &pages_[frame_id];
-    page->frame_mutex_.lock();
-    
-    // page->WLatch();
-    // free_list_latch_.WUnlock();
-  } else {
-    // free_list_latch_.WUnlock();
-    // evict
-    frame_id = Victim();
-    if(frame_id == -1){
-      LOG_WARN("no avalide frame") ;  
-      Print();
-      return nullptr;
-    }
-    page = &pages_[frame_id];
-    page->frame_mutex_.lock();
-   
-    if (page->IsDirty()) {
-      page->RLatch();
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      page->RUnlatch();
-      page->is_dirty_ = false;
-    }
-    page_table_->Remove(page->page_id_);
-    page->Remove();
+  frame_id_t frame_id = AcquireFrame(&lock);
+  if (frame_id == -1) {
+    stats_.pinned_failures_++;
+    LOG_WARN("no avalide frame");
+    Print();
+    return nullptr;
   }
-  page_id_t new_page_id = AllocatePage();
-  page_table_->Insert(new_page_id, frame_id);
-  lock.unlock();
+  Page *page = &pages_[frame_id];
+  page_id_t new_page_id = AllocatePage(segment);
 
-  page->pin_count_ = 0;
-  page->ClearAccessHistory();
-
-  
-// std::cout << "new_page_id=" << new_page_id  << ", frame_id=" << frame_id << std::endl;
-  page->is_dirty_ = true;
-  page->ResetMemory();
-  page->RecordAccess(++current_timestamp_);
   page->page_id_ = new_page_id;
+  page->is_dirty_ = true;
+  page->referenced_ = true;
   page->state_ = Page::State::NORMAL;
+  // Nobody else waits on a frame that just left the free list or the replacer, so this never blocks.
+  page->frame_mutex_.lock();
+  // Publish the frame. Hits can pin it from now on, and wait on frame_mutex_ until it is ready.
+  page->pin_count_ = 1;
+  page_table_.Insert(new_page_id, frame_id);
+  replacer_->Admit(frame_id, new_page_id);
+  lock.unlock();
+  stats_.new_pages_++;
+
+  page->ResetMemory();
+  page->frame_mutex_.unlock();
 
   if (page_id != nullptr) {
     *page_id = new_page_id;
   }
-  page->frame_mutex_.unlock();
   return page;
 }
 
-/**
- * 需要考虑的情况
- * 1. 同时evict
- * 2. evict and cache hit ocurce simultaneously.
-*/
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  frame_id_t frame_id;
-  Page *page;
-  std::unique_lock lock(mutex_);
-  if (page_table_->Find(page_id, frame_id)) {
-    page = &pages_[frame_id];
-// std::cout << "FetchPgImp hit frame_id=" << frame_id << ", page_id=" << page.GetPageId()  << std::endl;    
-    page->frame_mutex_.lock();
-    page->RecordAccess(++current_timestamp_);
-    page->frame_mutex_.unlock();
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  // A hit on a pinned frame. A bulk read only pins the page, it must neither promote a hot page nor one of its own
+  // ring. The page may still be being read in by another thread, so wait on the frame.
+  auto hit = [&](frame_id_t frame_id) {
+    Page *page = &pages_[frame_id];
+    if (strategy == nullptr) {
+      replacer_->RecordAccess(frame_id);
+      page->referenced_ = true;
+    }
+    stats_.hits_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_lock io_lock(page->frame_mutex_);
     return page;
-  }
-  
+  };
 
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-    page = &pages_[frame_id];
-    page->frame_mutex_.lock();
-  } else {
+  frame_id_t frame_id = PinResident(page_id);
+  if (frame_id != -1) {
+    return hit(frame_id);
+  }
 
-    // evict
-    frame_id = Victim();
-    if(frame_id == -1){
-      LOG_WARN("no avalide frame") ;  
+  Page *page;
+  std::unique_lock lock(mutex_);
+  frame_id_t new_frame_id = -1;
+  while (true) {
+    if (page_table_.Find(page_id, frame_id)) {
+      if (new_frame_id != -1) {
+        // Someone else brought the page in while the latch was released to write back our victim.
+        PutFreeFrame(new_frame_id);
+      }
+      page = &pages_[frame_id];
+      page->pin_count_++;
+      lock.unlock();
+      return hit(frame_id);
+    }
+    if (new_frame_id != -1) {
+      break;
+    }
+    new_frame_id = AcquireFrame(&lock, strategy);
+    if (new_frame_id == -1) {
+      stats_.pinned_failures_++;
+      LOG_WARN("no avalide frame");
       Print();
       return nullptr;
     }
-    page = &pages_[frame_id];
-    page->frame_mutex_.lock();
-    
-    if (page->IsDirty()) {
-      page->RLatch();
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      page->RUnlatch();
-      page->is_dirty_ = false;
-    }
-    page_table_->Remove(page->page_id_);
-    page->Remove();
-    
-  }
-  
-  page_table_->Insert(page_id, frame_id);
-  lock.unlock();
-  
-  page->pin_count_ = 0;
-  page->ClearAccessHistory();
+  }
+  frame_id = new_frame_id;
+  page = &pages_[frame_id];
 
-  page->RecordAccess(++current_timestamp_);
-  page->ResetMemory();
   page->page_id_ = page_id;
-  page->state_ = Page::State::NORMAL;
-  
-  disk_manager_->ReadPage(page_id, page->GetData());
   page->is_dirty_ = false;
+  page->referenced_ = strategy == nullptr;
+  page->state_ = Page::State::NORMAL;
+  // Hold the frame in the "I/O in progress" state while the page is read without the pool latch. Concurrent
+  // fetchers of this page find it in the page table, pin it and block on frame_mutex_ until the read is done.
+  page->frame_mutex_.lock();
+  page->pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->Admit(frame_id, page_id);
+  lock.unlock();
+  stats_.misses_++;
 
+  page->ResetMemory();
+  TimeIo(&stats_.read_time_us_, [&] { disk_manager_->ReadPage(page_id, page->GetData()); });
   page->frame_mutex_.unlock();
 
   return page;
 }
 
+auto BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) -> bool {
+  std::vector<size_t> missed;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    frame_id_t frame_id = PinResident(page_ids[i]);
+    pages[i] = frame_id == -1 ? nullptr : &pages_[frame_id];
+    if (frame_id == -1) {
+      missed.push_back(i);
+    }
+  }
+
+  // Map a frame for every miss like FetchPgImp() does, all under one acquisition of the latch. A page listed twice
+  // is found in the page table the second time.
+  std::vector<std::pair<page_id_t, frame_id_t>> mapped;
+  std::vector<bool> loaded(page_ids.size(), false);
+  bool fetched_all = true;
+  if (!missed.empty()) {
+    std::unique_lock lock(mutex_);
+    for (size_t i : missed) {
+      frame_id_t frame_id;
+      frame_id_t new_frame_id = -1;
+      while (true) {
+        if (page_table_.Find(page_ids[i], frame_id)) {
+          if (new_frame_id != -1) {
+            PutFreeFrame(new_frame_id);
+          }
+          pages_[frame_id].pin_count_++;
+          pages[i] = &pages_[frame_id];
+          break;
+        }
+        if (new_frame_id != -1) {
+          Page &page = pages_[new_frame_id];
+          page.page_id_ = page_ids[i];
+          page.is_dirty_ = false;
+          page.referenced_ = true;
+          page.state_ = Page::State::NORMAL;
+          page.frame_mutex_.lock();
+          page.pin_count_ = 1;
+          page_table_.Insert(page_ids[i], new_frame_id);
+          replacer_->Admit(new_frame_id, page_ids[i]);
+          mapped.emplace_back(page_ids[i], new_frame_id);
+          pages[i] = &page;
+          loaded[i] = true;
+          break;
+        }
+        new_frame_id = AcquireFrame(&lock);
+        if (new_frame_id == -1) {
+          stats_.pinned_failures_++;
+          fetched_all = false;
+          break;
+        }
+      }
+    }
+  }
+  stats_.misses_ += mapped.size();
+  std::sort(mapped.begin(), mapped.end());
+  LoadPages(mapped);
+
+  // Record the hits, and wait for the pages that other threads are still reading in.
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (pages[i] == nullptr || loaded[i]) {
+      continue;
+    }
+    replacer_->RecordAccess(static_cast<frame_id_t>(pages[i] - pages_));
+    pages[i]->referenced_ = true;
+    stats_.hits_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_lock io_lock(pages[i]->frame_mutex_);
+  }
+  return fetched_all;
+}
+
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
   frame_id_t frame_id;
   if(page_id == INVALID_PAGE_ID) {
     return false;
   }
-    
-  std::unique_lock lock(mutex_);
-  if (!page_table_->Find(page_id, frame_id)) {
+
+  if (!page_table_.Find(page_id, frame_id)) {
     return false;
   }
 
+  // The caller holds a pin, so the frame cannot be remapped under us.
   Page &page = pages_[frame_id];
-  // page.WLatch();
-  std::unique_lock frame_lock(page.frame_mutex_);
-  page.pin_count_--;
-  if (page.pin_count_ < 0) {
-    LOG_WARN("\n page.pin_count_ < 0 , pageid = %d, pin_count = %d", page.GetPageId(),  page.pin_count_ );
-    // BUSTUB_ASSERT(false, "page.pin_count_ < 0");
-    // return false;
-  }  
-
-  if (page.pin_count_ <= 0 && page.state_ ==  Page::State::WAITTING_TO_DELETE) {
-    // delete page
-    // std::cout << "delete page " << page_id <<  std::endl;
-    page_table_->Remove(page_id);
-    page.Remove();
-    free_list_.push_back(frame_id);
-    lock.unlock();
-
-    page.state_ = Page::State::NORMAL;
-    page.ClearAccessHistory();
-    page.WLatch();
-    page.ResetMemory();
-    page.WUnlatch();
-    DeallocatePage(page_id);
-    
-  } else {
-
-    if(is_dirty){
-      page.is_dirty_ = is_dirty;
-    }
+  if (page.page_id_ != page_id || page.pin_count_ <= 0) {
+    LOG_WARN("\n page.pin_count_ <= 0 , pageid = %d, pin_count = %d", page_id, page.GetPinCount());
+    return false;
   }
-  
-  return true;
+  // Set before the pin is dropped, so that whoever evicts the page sees it dirty.
+  if (is_dirty) {
+    page.is_dirty_ = is_dirty;
+  }
+  return ReleasePin(frame_id);
 }
 
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   frame_id_t frame_id;
   std::unique_lock lock(mutex_);
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!page_table_.Find(page_id, frame_id)) {
     return false;
   }
   Page &page = pages_[frame_id];
-  std::unique_lock frame_lock(page.frame_mutex_);
-  if (!page.Evictable() ) {
+  if (!page.Claim(0)) {
     page.state_ = Page::State::WAITTING_TO_DELETE;
     // LOG_WARN("Delete a currently active page %d", page.page_id_);
+    // The last pin may have been dropped before the state was set, then the unpinner did not see it.
+    if (page.Claim(0)) {
+      FreeFrame(frame_id);
+    }
     return false;
   }
-  page_table_->Remove(page_id);
-  page.Remove();
-  free_list_.push_back(frame_id);
-  lock.unlock();
-  
-  page.pin_count_ = 0;
-  page.is_dirty_ = false;
-  page.ClearAccessHistory();
-  page.WLatch();
-  page.ResetMemory();
-  page.WUnlatch();
-  DeallocatePage(page_id);
- 
+  FreeFrame(frame_id);
   return true;
 }
 
@@ -243,87 +332,638 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "page_id cannot be INVALID_PAGE_ID)");
   frame_id_t frame_id;
   std::unique_lock lock(mutex_);
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!page_table_.Find(page_id, frame_id)) {
     return false;
   }
-
+  // Pin the frame so that it stays mapped to page_id while it is written without the pool latch.
   Page &page = pages_[frame_id];
-  std::unique_lock frame_lock(page.frame_mutex_);
+  page.pin_count_++;
+  page.is_dirty_ = false;
   lock.unlock();
-  if(!page.IsRemoved()){
+
+  {
+    std::shared_lock io_lock(page.frame_mutex_);
     page.RLatch();
-    disk_manager_->WritePage(page.GetPageId(), page.GetData());
+    TimeIo(&stats_.write_time_us_, [&] { disk_manager_->WritePage(page_id, page.GetData()); });
     page.RUnlatch();
-    page.is_dirty_ = false;
   }
-  
+  stats_.flushes_++;
+
+  lock.lock();
+  UnpinFrame(frame_id);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  for (size_t i = 0; i < pool_size_; i++) {
-    Page &page = pages_[i];
-    std::unique_lock frame_lock(page.frame_mutex_);
-    if (page.IsRemoved()) {
-      
+  WriteDirtyPages();
+  disk_manager_->SyncPages();
+}
+
+auto BufferPoolManagerInstance::WriteDirtyPages() -> size_t {
+  // Pin the dirty frames like FlushPgImp() does, so that they stay mapped while they are written without the latch.
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  {
+    std::scoped_lock lock(mutex_);
+    for (size_t i = 0; i < pool_size_; i++) {
+      Page &page = pages_[i];
+      if (page.page_id_ != INVALID_PAGE_ID && page.is_dirty_) {
+        page.pin_count_++;
+        dirty.emplace_back(page.page_id_, static_cast<frame_id_t>(i));
+      }
+    }
+  }
+  std::sort(dirty.begin(), dirty.end());
+
+  // Only the first page latch of a run is waited for, the others are tried: waiting for one latch while holding
+  // others could deadlock with a thread latching the same pages in another order. A page whose latch is taken starts
+  // the next run instead.
+  std::vector<const char *> run;
+  for (size_t begin = 0; begin < dirty.size();) {
+    size_t end = begin;
+    run.clear();
+    while (end < dirty.size() && (end == begin || dirty[end].first == dirty[end - 1].first + 1)) {
+      Page &page = pages_[dirty[end].second];
+      page.frame_mutex_.lock_shared();
+      if (end == begin) {
+        page.RLatch();
+      } else if (!page.TryRLatch()) {
+        page.frame_mutex_.unlock_shared();
+        break;
+      }
+      page.is_dirty_ = false;
+      run.push_back(page.GetData());
+      end++;
+    }
+    TimeIo(&stats_.write_time_us_, [&] { disk_manager_->WritePages(dirty[begin].first, run.size(), run.data()); });
+    for (size_t i = begin; i < end; i++) {
+      Page &page = pages_[dirty[i].second];
+      page.RUnlatch();
+      page.frame_mutex_.unlock_shared();
+    }
+    begin = end;
+  }
+  stats_.flushes_ += dirty.size();
+
+  std::scoped_lock lock(mutex_);
+  for (auto &[page_id, frame_id] : dirty) {
+    UnpinFrame(frame_id);
+  }
+  return dirty.size();
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(std::unique_lock<std::mutex> *lock, BufferAccessStrategy *strategy)
+    -> frame_id_t {
+  frame_id_t ring_frame_id = strategy == nullptr ? -1 : RingVictim(strategy);
+  while (true) {
+    // The ring frame is only tried once. If it is used again while it is written back, fall back to a regular victim.
+    frame_id_t frame_id = ring_frame_id;
+    ring_frame_id = -1;
+    if (frame_id == -1 && !free_list_.empty()) {
+      frame_id = free_list_.front();
+      free_list_.pop_front();
+      if (strategy != nullptr) {
+        strategy->SetCurrent(&pages_[frame_id]);
+      }
+      return frame_id;
+    }
+
+    if (frame_id == -1) {
+      frame_id = Victim();
+    }
+    if (frame_id == -1) {
+      return -1;
+    }
+    if (!EvictFrame(lock, frame_id)) {
+      continue;
+    }
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      // The pool shrank while the victim was written back.
+      PutFreeFrame(frame_id);
       continue;
     }
+    if (strategy != nullptr) {
+      strategy->SetCurrent(&pages_[frame_id]);
+    }
+    return frame_id;
+  }
+}
+
+auto BufferPoolManagerInstance::EvictFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  if (page.IsDirty() && page.state_ != Page::State::WAITTING_TO_DELETE) {
+    // Write the victim back without the pool latch. The frame stays mapped and pinned meanwhile, so that a fetcher
+    // of the old page finds it in memory instead of reading a stale copy from disk, and no one else evicts it.
+    page_id_t old_page_id = page.page_id_;
+    if (enable_cleaner_) {
+      // The page cleaner is falling behind.
+      cleaner_cv_.notify_one();
+    }
+    page.pin_count_++;
+    page.is_dirty_ = false;
+    lock->unlock();
+
     page.RLatch();
-    disk_manager_->WritePage(page.GetPageId(), page.GetData());
+    TimeIo(&stats_.write_time_us_, [&] { disk_manager_->WritePage(old_page_id, page.GetData()); });
     page.RUnlatch();
-    page.is_dirty_ = false;
-    
+
+    lock->lock();
+    if (!page.Claim(1)) {
+      // The page was used again while it was written.
+      UnpinFrame(frame_id);
+      return false;
+    }
+    if (page.IsDirty() && page.state_ != Page::State::WAITTING_TO_DELETE) {
+      page.pin_count_ = 0;
+      return false;
+    }
+    stats_.dirty_evictions_++;
+  } else if (!page.Claim(0)) {
+    // A buffer hit pinned it since the caller looked at it.
+    return false;
+  }
+
+  if (page.state_ == Page::State::WAITTING_TO_DELETE) {
+    DeallocatePage(page.page_id_);
+  }
+  replacer_->Remove(frame_id, true);
+  page_table_.Remove(page.page_id_);
+  stats_.evictions_++;
+  page.Remove();
+  return true;
+}
+
+auto BufferPoolManagerInstance::RingVictim(BufferAccessStrategy *strategy) -> frame_id_t {
+  Page *frame = strategy->Next();
+  // The ring of a parallel BPM spans every instance, skip the frames of the others.
+  if (frame == nullptr || frame < pages_ || frame >= pages_ + num_frames_) {
+    return -1;
+  }
+  if (frame->IsRemoved() || !frame->Evictable() || frame->referenced_) {
+    return -1;
+  }
+  return static_cast<frame_id_t>(frame - pages_);
+}
+
+void BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  page.pin_count_--;
+  if (page.state_ == Page::State::WAITTING_TO_DELETE && page.Claim(0)) {
+    FreeFrame(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) -> bool {
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1 && page.state_ == Page::State::WAITTING_TO_DELETE) {
+    std::scoped_lock lock(mutex_);
+    if (page.state_ == Page::State::WAITTING_TO_DELETE && page.Claim(0)) {
+      FreeFrame(frame_id);
+    }
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  page_id_t page_id = page.page_id_;
+  replacer_->Remove(frame_id, false);
+  page_table_.Remove(page_id);
+  page.Remove();
+  page.is_dirty_ = false;
+  PutFreeFrame(frame_id);
+  DeallocatePage(page_id);
+}
+
+void BufferPoolManagerInstance::PutFreeFrame(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+    return;
+  }
+  // Release the data of a frame above the pool size, it reads as zeros when the pool grows again. The frame itself
+  // stays, claimed, for stale page table lookups.
+  Page &page = pages_[frame_id];
+  madvise(page.data_, BUSTUB_PAGE_SIZE, MADV_DONTNEED);
+  page.data_ = nullptr;
+}
+
+void BufferPoolManagerInstance::AddFrames(size_t new_size) {
+  page_table_.Grow(new_size);
+  replacer_->SetPoolSize(new_size);
+  for (size_t i = pool_size_; i < new_size; i++) {
+    Page &page = pages_[i];
+    if (i == num_frames_) {
+      new (&page) Page();
+      num_frames_++;
+    }
+    page.data_ = frame_data_ + i * BUSTUB_PAGE_SIZE;
+    // Free frames are claimed, so that a stale page table lookup cannot pin them.
+    page.pin_count_ = Page::FRAME_CLAIMED;
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+  pool_size_ = new_size;
+}
+
+auto BufferPoolManagerInstance::Resize(size_t new_size) -> bool {
+  if (new_size == 0 || new_size > BUFFER_POOL_MAX_FRAMES) {
+    return false;
+  }
+  std::scoped_lock resize_lock(resize_mutex_);
+  std::unique_lock lock(mutex_);
+  const size_t old_size = pool_size_;
+  if (new_size >= old_size) {
+    AddFrames(new_size);
+    return true;
   }
+
+  // From now on the frames above new_size are not handed out anymore. The free ones are released right away, the
+  // others when they are evicted, here or by a miss that picked them as a victim.
+  pool_size_ = new_size;
+  replacer_->SetPoolSize(new_size);
+  std::list<frame_id_t> free_frames;
+  free_frames.swap(free_list_);
+  for (frame_id_t frame_id : free_frames) {
+    PutFreeFrame(frame_id);
+  }
+  for (size_t i = new_size; i < old_size; i++) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page &page = pages_[frame_id];
+    while (page.data_ != nullptr) {
+      if (!page.IsRemoved() && page.Evictable() && EvictFrame(&lock, frame_id)) {
+        PutFreeFrame(frame_id);
+        continue;
+      }
+      // Pinned, wait for it to be unpinned. The frame may also be freed by its last unpin meanwhile, if its page was
+      // deleted.
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      lock.lock();
+    }
+  }
+  return true;
 }
 
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { 
-  return next_page_id_++; 
+auto BufferPoolManagerInstance::AllocatePage(page_id_t segment) -> page_id_t {
+  const page_id_t next_page_id = disk_manager_->AllocatePage(num_instances_, instance_index_, segment);
+  BUSTUB_ASSERT(next_page_id % static_cast<page_id_t>(num_instances_) == static_cast<page_id_t>(instance_index_),
+                "allocated pages must mod back to this BPI");
+  return next_page_id;
 }
 
  
 
 auto BufferPoolManagerInstance::Victim() -> frame_id_t {
-  frame_id_t max_k_dist_frame_id = -1;
-  size_t max_k_dist = 0;
-  
-  // if (evictable_size_ == 0) return false;
-  for (size_t i = 0; i < pool_size_; i++) {
-    Page& frame = pages_[i];
-    std::shared_lock frame_lock(frame.frame_mutex_);
-    if(frame.IsRemoved() || !frame.Evictable()){
-      // frame.RUnlatch();
-      frame_lock.unlock();
+  return replacer_->Victim([this](frame_id_t frame_id) { return pages_[frame_id].Evictable(); });
+}
+
+auto BufferPoolManagerInstance::PinResident(page_id_t page_id) -> frame_id_t {
+  // The frame may be remapped between the lookup and the pin, so check it afterwards.
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, frame_id)) {
+    Page &page = pages_[frame_id];
+    if (page.TryPin()) {
+      if (page.page_id_ == page_id) {
+        return frame_id;
+      }
+      ReleasePin(frame_id);
+    }
+  }
+  return -1;
+}
+
+void BufferPoolManagerInstance::LoadPages(const std::vector<std::pair<page_id_t, frame_id_t>> &mapped) {
+  TimeIo(&stats_.read_time_us_, [&] {
+    std::vector<std::pair<frame_id_t, std::future<bool>>> reads;
+    // Aligned like the frames, for the disk managers doing direct I/O.
+    std::unique_ptr<char, decltype(&std::free)> buffer(nullptr, &std::free);
+    for (size_t begin = 0; begin < mapped.size();) {
+      size_t end = begin + 1;
+      while (end < mapped.size() && end - begin < static_cast<size_t>(WARM_UP_BATCH_SIZE) &&
+             mapped[end].first == mapped[end - 1].first + 1) {
+        end++;
+      }
+      if (end - begin == 1) {
+        Page &page = pages_[mapped[begin].second];
+        if (mapped.size() == 1) {
+          // Nothing to overlap the read with.
+          disk_manager_->ReadPage(mapped[begin].first, page.GetData());
+          page.frame_mutex_.unlock();
+        } else {
+          // A lone page is read straight into its frame, in the background while the other pages are read.
+          reads.emplace_back(mapped[begin].second, ScheduleIo(false, mapped[begin].first, page.GetData()));
+        }
+        begin = end;
+        continue;
+      }
+      if (buffer == nullptr) {
+        buffer.reset(static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, WARM_UP_BATCH_SIZE * BUSTUB_PAGE_SIZE)));
+      }
+      disk_manager_->ReadPages(mapped[begin].first, end - begin, buffer.get());
+      for (size_t i = begin; i < end; i++) {
+        Page &page = pages_[mapped[i].second];
+        memcpy(page.GetData(), buffer.get() + (i - begin) * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE);
+        page.frame_mutex_.unlock();
+      }
+      begin = end;
+    }
+    for (auto &[frame_id, read] : reads) {
+      read.get();
+      pages_[frame_id].frame_mutex_.unlock();
+    }
+  });
+}
+
+auto BufferPoolManagerInstance::ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool> {
+  auto promise = disk_scheduler_.CreatePromise();
+  auto future = promise.get_future();
+  disk_scheduler_.Schedule({is_write, data, page_id, std::move(promise)});
+  return future;
+}
+
+void BufferPoolManagerInstance::StartPageCleaner(size_t batch_size, double dirty_ratio) {
+  BUSTUB_ASSERT(batch_size > 0, "page cleaner batch size must be positive");
+  std::scoped_lock lock(mutex_);
+  if (cleaner_thread_ != nullptr) {
+    return;
+  }
+  cleaner_batch_size_ = batch_size;
+  cleaner_dirty_ratio_ = dirty_ratio;
+  enable_cleaner_ = true;
+  cleaner_thread_ = new std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock lock(mutex_);
+    if (cleaner_thread_ == nullptr) {
+      return;
+    }
+    enable_cleaner_ = false;
+  }
+  cleaner_cv_.notify_all();
+  cleaner_thread_->join();
+  delete cleaner_thread_;
+  cleaner_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+  std::unique_lock lock(mutex_);
+  while (enable_cleaner_) {
+    cleaner_cv_.wait_for(lock, page_cleaner_interval);
+    if (enable_cleaner_) {
+      CleanPages(&lock);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  if (page_ids.empty()) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  for (page_id_t page_id : page_ids) {
+    prefetch_queue_.push_back(page_id);
+  }
+  // Requests nobody could keep in the pool anyway are dropped, oldest first.
+  while (prefetch_queue_.size() > pool_size_) {
+    prefetch_queue_.pop_front();
+  }
+  if (prefetch_thread_ == nullptr) {
+    enable_prefetcher_ = true;
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+  std::unique_lock lock(mutex_);
+  std::vector<page_id_t> batch;
+  std::vector<Page *> pages;
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return !enable_prefetcher_ || !prefetch_queue_.empty(); });
+    if (!enable_prefetcher_) {
+      return;
+    }
+    // A prefetch is only a hint, never wait for a frame to be unpinned.
+    if (free_list_.empty() && Victim() == -1) {
+      prefetch_queue_.clear();
+      continue;
+    }
+    batch.clear();
+    while (!prefetch_queue_.empty() && batch.size() < static_cast<size_t>(DISK_SCHEDULER_QUEUE_DEPTH)) {
+      page_id_t page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      frame_id_t frame_id;
+      if (!page_table_.Find(page_id, frame_id) && std::find(batch.begin(), batch.end(), page_id) == batch.end()) {
+        batch.push_back(page_id);
+      }
+    }
+    if (batch.empty()) {
       continue;
     }
-    size_t k_dist = frame.KDistance(current_timestamp_);
-    if(max_k_dist_frame_id == -1){
-      max_k_dist = k_dist;
-      max_k_dist_frame_id = i;
-    }
-    else if (k_dist > max_k_dist) {
-      max_k_dist = k_dist;
-      max_k_dist_frame_id = i;
-    } else if (k_dist == max_k_dist) {
-      if (frame.Distance(current_timestamp_) > pages_[max_k_dist_frame_id].Distance(current_timestamp_)) {
-        // frames_[max_k_dist_frame_id].RUnlatch();
-        max_k_dist_frame_id = i;
+    lock.unlock();
+    pages.resize(batch.size());
+    FetchPages(batch, pages.data());
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (pages[i] != nullptr) {
+        UnpinPgImp(batch[i], false);
       }
-    } else {
     }
-    frame_lock.unlock();
-    // frame.RUnlatch();
+    lock.lock();
+  }
+}
+
+auto BufferPoolManagerInstance::DumpPool(const std::string &dump_file) -> bool {
+  // Take a snapshot of the resident pages, then write the file without the latch.
+  std::vector<page_id_t> resident;
+  {
+    std::scoped_lock lock(mutex_);
+    replacer_->ForEach([&](frame_id_t frame_id) {
+      resident.push_back(pages_[frame_id].page_id_);
+      return true;
+    });
   }
 
-   
-  return max_k_dist_frame_id;
+  std::ofstream out(dump_file, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    LOG_WARN("can't open buffer pool dump file %s", dump_file.c_str());
+    return false;
+  }
+  auto write = [&out](auto value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+  write(POOL_DUMP_MAGIC);
+  write(static_cast<uint32_t>(resident.size()));
+  for (page_id_t page_id : resident) {
+    write(page_id);
+  }
+  out.close();
+  return !out.fail();
+}
+
+auto BufferPoolManagerInstance::WarmUp(const std::string &dump_file) -> size_t {
+  std::ifstream in(dump_file, std::ios::binary);
+  if (!in.is_open()) {
+    return 0;
+  }
+  auto read = [&in](auto *value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(value), sizeof(*value)));
+  };
+  uint32_t magic;
+  uint32_t num_pages;
+  if (!read(&magic) || magic != POOL_DUMP_MAGIC || !read(&num_pages)) {
+    LOG_WARN("bad buffer pool dump file %s", dump_file.c_str());
+    return 0;
+  }
+  std::vector<page_id_t> dumped;
+  for (uint32_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    if (!read(&page_id)) {
+      LOG_WARN("bad buffer pool dump file %s", dump_file.c_str());
+      return 0;
+    }
+    if (page_id >= 0 && page_id % static_cast<page_id_t>(num_instances_) == static_cast<page_id_t>(instance_index_)) {
+      dumped.push_back(page_id);
+    }
+  }
+  // The pool may have shrunk since the dump, keep the pages that would have been evicted last.
+  if (dumped.size() > pool_size_) {
+    dumped.erase(dumped.begin(), dumped.end() - static_cast<std::ptrdiff_t>(pool_size_.load()));
+  }
+
+  // Map the frames first, like a miss does, in dump order so that the replacer ranks them as they were. They stay
+  // pinned and in the "I/O in progress" state until loaded.
+  std::vector<std::pair<page_id_t, frame_id_t>> mapped;
+  {
+    std::scoped_lock lock(mutex_);
+    for (page_id_t page_id : dumped) {
+      frame_id_t frame_id;
+      if (page_table_.Find(page_id, frame_id)) {
+        continue;
+      }
+      if (free_list_.empty()) {
+        break;
+      }
+      frame_id = free_list_.front();
+      free_list_.pop_front();
+      Page &page = pages_[frame_id];
+      page.page_id_ = page_id;
+      page.is_dirty_ = false;
+      page.referenced_ = true;
+      page.state_ = Page::State::NORMAL;
+      page.frame_mutex_.lock();
+      page.pin_count_ = 1;
+      page_table_.Insert(page_id, frame_id);
+      replacer_->Admit(frame_id, page_id);
+      mapped.emplace_back(page_id, frame_id);
+    }
+  }
+
+  // Load runs of pages that are next to each other on disk with a single read.
+  std::sort(mapped.begin(), mapped.end());
+  LoadPages(mapped);
+  for (auto &[page_id, frame_id] : mapped) {
+    ReleasePin(frame_id);
+  }
+  return mapped.size();
+}
+
+auto BufferPoolManagerInstance::CleanPages(std::unique_lock<std::mutex> *lock) -> size_t {
+  // Walk the frames roughly in the order Victim() would pick them. The next batch_size victims are always
+  // cleaned, frames further down only while the pool is dirtier than the target.
+  const auto dirty_target = static_cast<size_t>(cleaner_dirty_ratio_ * static_cast<double>(pool_size_));
+  size_t dirty_evictable = 0;
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page &page = pages_[i];
+    if (!page.IsRemoved() && page.Evictable() && page.IsDirty()) {
+      dirty_evictable++;
+    }
+  }
+  std::vector<frame_id_t> batch;
+  size_t position = 0;
+  replacer_->ForEach([&](frame_id_t frame_id) {
+    Page &page = pages_[frame_id];
+    if (!page.Evictable()) {
+      // Pinned frames are not in the replacement order.
+      return true;
+    }
+    if (batch.size() >= cleaner_batch_size_ ||
+        (position >= cleaner_batch_size_ && dirty_evictable - batch.size() <= dirty_target)) {
+      return false;
+    }
+    if (page.IsDirty()) {
+      batch.push_back(frame_id);
+    }
+    position++;
+    return true;
+  });
+  if (batch.empty()) {
+    return 0;
+  }
+
+  // Pin the frames like FlushPgImp() does, so that they stay mapped while they are written without the latch.
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(batch.size());
+  for (frame_id_t frame_id : batch) {
+    Page &page = pages_[frame_id];
+    page.pin_count_++;
+    page_ids.push_back(page.page_id_);
+  }
+  lock->unlock();
+
+  // The page latches are held until all the writes are done. Waiting for one while holding others could deadlock
+  // with a thread latching the same pages in another order, so a page whose latch is taken is left for next time.
+  std::vector<std::future<bool>> writes;
+  std::vector<frame_id_t> written;
+  for (size_t i = 0; i < batch.size(); i++) {
+    Page &page = pages_[batch[i]];
+    if (!page.TryRLatch()) {
+      continue;
+    }
+    page.is_dirty_ = false;
+    writes.push_back(ScheduleIo(true, page_ids[i], page.GetData()));
+    written.push_back(batch[i]);
+  }
+  TimeIo(&stats_.write_time_us_, [&] {
+    for (auto &write : writes) {
+      write.get();
+    }
+  });
+  for (frame_id_t frame_id : written) {
+    pages_[frame_id].RUnlatch();
+  }
+  stats_.flushes_ += written.size();
+
+  lock->lock();
+  for (frame_id_t frame_id : batch) {
+    UnpinFrame(frame_id);
+  }
+  return written.size();
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.hits_ = stats_.hits_;
+  stats.misses_ = stats_.misses_;
+  stats.new_pages_ = stats_.new_pages_;
+  stats.evictions_ = stats_.evictions_;
+  stats.dirty_evictions_ = stats_.dirty_evictions_;
+  stats.flushes_ = stats_.flushes_;
+  stats.pinned_failures_ = stats_.pinned_failures_;
+  stats.read_time_us_ = stats_.read_time_us_;
+  stats.write_time_us_ = stats_.write_time_us_;
+  return stats;
 }
 
 void BufferPoolManagerInstance::Print()  {
   std::cout << "----------BufferPoolManager-----------" << std::endl;
   for (size_t i = 0; i < pool_size_; ++i) {
     Page& frame = pages_[i];
-    std::cout << "frame_id: " << i << ", page_id: " <<  frame.page_id_ << ", pin_count: " << frame.pin_count_ << std::endl;
+    std::cout << "frame_id: " << i << ", page_id: " <<  frame.GetPageId() << ", pin_count: " << frame.GetPinCount() << std::endl;
   }
   std::cout << "--------------------------------------" << std::endl;
 }
@@ -334,11 +974,11 @@ auto BufferPoolManagerInstance::Check() ->bool  {
   std::set<page_id_t> set;
   for (size_t i = 0; i < pool_size_; ++i) {
     Page& frame = pages_[i];
-    if(set.find(frame.page_id_) != set.end()){
+    if(set.find(frame.GetPageId()) != set.end()){
       std::cout << "same pageid at diffrent frame " << std::endl;
       suc = false;
     }
-    set.insert(frame.page_id_);
+    set.insert(frame.GetPageId());
   }
   return suc;
    
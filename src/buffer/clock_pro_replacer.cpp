@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_frames) { SetPoolSize(num_frames); }
+
+void ClockProReplacer::SetPoolSize(size_t pool_size) {
+  frames_.Grow(pool_size);
+  if (c_ == 0) {
+    // Start with most of the pool for the hot pages, the misses in test periods tell how much the cold ones need.
+    cold_target_ = pool_size / 4;
+  }
+  c_ = pool_size;
+  cold_target_ = std::clamp<size_t>(cold_target_, 1, std::max<size_t>(1, c_));
+}
+
+void ClockProReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  frame.ref_ = false;
+  bool hot = false;
+  auto test = tests_.find(page_id);
+  if (test != tests_.end()) {
+    // Missed during its test period: its reuse distance is short enough for a hot page, and cold pages need more room.
+    cold_target_ = std::min(c_, cold_target_ + 1);
+    Erase(test->second);
+    tests_.erase(test);
+    num_test_--;
+    hot = true;
+  }
+  frame.position_ = clock_.insert(hand_hot_, Entry{page_id, frame_id, hot});
+  if (hot) {
+    num_hot_++;
+  } else {
+    num_cold_++;
+  }
+}
+
+void ClockProReplacer::RecordAccess(frame_id_t frame_id) {
+  Frame &frame = frames_[frame_id];
+  if (!frame.ref_.load(std::memory_order_relaxed)) {
+    frame.ref_.store(true, std::memory_order_relaxed);
+  }
+}
+
+auto ClockProReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  // Every step of a hand clears a reference bit, changes the status of a page or skips an entry: a few turns are
+  // enough, unless pinned pages keep the hands going around. Then take any unpinned page.
+  const size_t max_steps = 4 * clock_.size() + 1;
+  for (size_t steps = 0; steps < max_steps; steps++) {
+    if (num_hot_ + num_cold_ == 0) {
+      return -1;
+    }
+    if (num_cold_ == 0 || num_hot_ > c_ - std::min(c_, cold_target_)) {
+      RunHandHot();
+      continue;
+    }
+    Position entry = HandEntry(&hand_cold_);
+    ++hand_cold_;
+    if (entry->frame_id_ == -1 || entry->hot_) {
+      continue;
+    }
+    if (frames_[entry->frame_id_].ref_.exchange(false)) {
+      // Accessed again during its test period.
+      entry->hot_ = true;
+      num_cold_--;
+      num_hot_++;
+      continue;
+    }
+    if (evictable(entry->frame_id_)) {
+      // Leave the hand on the victim, Remove() moves it on.
+      hand_cold_ = entry;
+      return entry->frame_id_;
+    }
+  }
+  for (Entry &entry : clock_) {
+    if (entry.frame_id_ != -1 && evictable(entry.frame_id_)) {
+      return entry.frame_id_;
+    }
+  }
+  return -1;
+}
+
+void ClockProReplacer::Remove(frame_id_t frame_id, bool evicted) {
+  Position entry = frames_[frame_id].position_;
+  if (entry->hot_) {
+    num_hot_--;
+  } else {
+    num_cold_--;
+  }
+  if (!evicted || entry->hot_) {
+    Erase(entry);
+    return;
+  }
+  entry->frame_id_ = -1;
+  tests_[entry->page_id_] = entry;
+  num_test_++;
+  while (num_test_ > c_) {
+    RunHandTest();
+  }
+}
+
+void ClockProReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  if (clock_.empty()) {
+    return;
+  }
+  Position start = hand_cold_ == clock_.end() ? clock_.begin() : hand_cold_;
+  for (bool hot : {false, true}) {
+    Position it = start;
+    do {
+      if (it->frame_id_ != -1 && it->hot_ == hot && !visit(it->frame_id_)) {
+        return;
+      }
+      if (++it == clock_.end()) {
+        it = clock_.begin();
+      }
+    } while (it != start);
+  }
+}
+
+void ClockProReplacer::RunHandHot() {
+  Position entry = HandEntry(&hand_hot_);
+  ++hand_hot_;
+  if (entry->frame_id_ == -1 || !entry->hot_) {
+    return;
+  }
+  if (!frames_[entry->frame_id_].ref_.exchange(false)) {
+    entry->hot_ = false;
+    num_hot_--;
+    num_cold_++;
+  }
+}
+
+void ClockProReplacer::RunHandTest() {
+  Position entry = HandEntry(&hand_test_);
+  ++hand_test_;
+  if (entry->frame_id_ != -1) {
+    return;
+  }
+  // The test period ended without an access.
+  cold_target_ = std::max<size_t>(1, cold_target_ - 1);
+  tests_.erase(entry->page_id_);
+  num_test_--;
+  Erase(entry);
+}
+
+auto ClockProReplacer::HandEntry(Position *hand) -> Position {
+  if (*hand == clock_.end()) {
+    *hand = clock_.begin();
+  }
+  return *hand;
+}
+
+void ClockProReplacer::Erase(Position position) {
+  for (Position *hand : {&hand_cold_, &hand_hot_, &hand_test_}) {
+    if (*hand == position) {
+      ++*hand;
+    }
+  }
+  clock_.erase(position);
+}
+
+}  // namespace bustub
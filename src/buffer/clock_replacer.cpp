@@ -14,16 +14,69 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_frames) { SetPoolSize(num_frames); }
 
-ClockReplacer::~ClockReplacer() = default;
+void ClockReplacer::SetPoolSize(size_t pool_size) { frames_.Grow(pool_size); }
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  frame.ref_ = false;
+  // Right behind the hand, i.e. the last frame it gets to.
+  if (hand_ == ring_.end()) {
+    hand_ = ring_.begin();
+  }
+  frame.position_ = ring_.insert(hand_, frame_id);
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  Frame &frame = frames_[frame_id];
+  if (!frame.ref_.load(std::memory_order_relaxed)) {
+    frame.ref_.store(true, std::memory_order_relaxed);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  // Two turns clear every reference bit. Hits may set them again meanwhile, then give up on them.
+  for (size_t steps = 0; steps < 2 * ring_.size() + 1; steps++) {
+    if (hand_ == ring_.end()) {
+      hand_ = ring_.begin();
+    }
+    if (hand_ == ring_.end()) {
+      return -1;
+    }
+    frame_id_t frame_id = *hand_;
+    if (!frames_[frame_id].ref_.exchange(false) && evictable(frame_id)) {
+      return frame_id;
+    }
+    ++hand_;
+  }
+  for (frame_id_t frame_id : ring_) {
+    if (evictable(frame_id)) {
+      return frame_id;
+    }
+  }
+  return -1;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id, bool evicted) {
+  Frame &frame = frames_[frame_id];
+  if (hand_ == frame.position_) {
+    ++hand_;
+  }
+  ring_.erase(frame.position_);
+}
+
+void ClockReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  for (auto it = hand_; it != ring_.end(); ++it) {
+    if (!visit(*it)) {
+      return;
+    }
+  }
+  for (auto it = ring_.begin(); it != hand_; ++it) {
+    if (!visit(*it)) {
+      return;
+    }
+  }
+}
 
 }  // namespace bustub
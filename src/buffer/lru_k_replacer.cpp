@@ -12,85 +12,105 @@
 
 #include "buffer/lru_k_replacer.h"
 
-namespace bustub {
+#include <vector>
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k), frames_(num_frames) {}
+namespace bustub {
 
-auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  frame_id_t max_k_dist_frame_id;
-  size_t max_k_dist = 0;
-  bool suc = false;
-  std::unique_lock lock(mutex_);
-  if (evictable_size_ == 0) return false;
-  for (size_t i = 0; i < frames_.size(); i++) {
-    std::shared_ptr<Frame> frame = frames_[i];
-    if (!frame || !frame->Evictable()) {
-      continue;
-    }
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : k_(k) {
+  BUSTUB_ASSERT(k > 0 && k <= static_cast<size_t>(LRUK_REPLACER_MAX_K), "k must be in [1, LRUK_REPLACER_MAX_K]");
+  SetPoolSize(num_frames);
+}
 
-    suc = true;
-    size_t k_dist = frame->KDistance(current_timestamp_);
-    if (k_dist > max_k_dist) {
-      max_k_dist = k_dist;
-      max_k_dist_frame_id = i;
-    } else if (k_dist == max_k_dist) {
-      if (frame->Distance(current_timestamp_) > frames_[max_k_dist_frame_id]->Distance(current_timestamp_)) {
-        max_k_dist_frame_id = i;
-      }
-    }
-  }
+void LRUKReplacer::SetPoolSize(size_t pool_size) { frames_.Grow(pool_size); }
 
-  if (suc) {
-    frames_[max_k_dist_frame_id] = nullptr;
-    evictable_size_--;
-    *frame_id = max_k_dist_frame_id;
+void LRUKReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  {
+    std::scoped_lock lock(frame.latch_);
+    frame.history_begin_ = 0;
+    frame.history_size_ = 0;
   }
-
-  return suc;
+  RecordAccess(frame_id);
+  IndexFrame(frame_id);
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
-  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid (ie. larger than replacer_size_)");
-  std::unique_lock lock(mutex_);
-  std::shared_ptr<Frame> &frame = frames_[frame_id];
-  if (!frame) {
-    frame = std::make_shared<Frame>(k_);
-    frames_[frame_id] = frame;
+  Frame &frame = frames_[frame_id];
+  std::scoped_lock lock(frame.latch_);
+  const size_t timestamp = ++current_timestamp_;
+  if (frame.history_size_ < k_) {
+    frame.history_[frame.history_size_++] = timestamp;
+    return;
   }
-  frame->RecordAccess(++current_timestamp_);
+  // Full: the oldest access makes room for this one, and the next oldest becomes the first.
+  frame.history_[frame.history_begin_] = timestamp;
+  frame.history_begin_ = frame.history_begin_ + 1 == k_ ? 0 : frame.history_begin_ + 1;
 }
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool evictable) {
-  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid (ie. larger than replacer_size_)");
-  std::unique_lock lock(mutex_);
-  std::shared_ptr<Frame> &frame = frames_[frame_id];
-  if (!frame) {
-    return;
+auto LRUKReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  for (auto *set : {&history_set_, &cache_set_}) {
+    auto it = set->begin();
+    while (it != set->end()) {
+      auto [earliest_access, frame_id] = *it;
+      Frame &frame = frames_[frame_id];
+      if (EvictionKey(frame) != frame.index_key_) {
+        // Accessed since it was filed. Its key only grew, so refile it and carry on from where it was: if it is
+        // still a candidate, it is looked at again further down.
+        set->erase(it);
+        IndexFrame(frame_id);
+        it = set->lower_bound({earliest_access, frame_id});
+        continue;
+      }
+      if (evictable(frame_id)) {
+        return frame_id;
+      }
+      ++it;
+    }
   }
-  if (evictable == frame->Evictable()) return;
-
-  evictable ? evictable_size_++ : evictable_size_--;
-  frame->SetEvictable(evictable);
+  return -1;
 }
 
-auto LRUKReplacer::Remove(frame_id_t frame_id) -> bool {
-  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "frame id is invalid (ie. larger than replacer_size_)");
-  std::unique_lock lock(mutex_);
-  std::shared_ptr<Frame> &frame = frames_[frame_id];
-  if (!frame) return false;
-  if (!frame->Evictable()) {
-    throw std::invalid_argument("Remove is called on a non-evictable frame.");
-    return false;
+void LRUKReplacer::Remove(frame_id_t frame_id, bool evicted) { UnindexFrame(frame_id); }
+
+void LRUKReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  // Refile the frames accessed since they were filed first, or they would be visited where they used to be.
+  std::vector<frame_id_t> stale;
+  for (auto *set : {&history_set_, &cache_set_}) {
+    for (auto [earliest_access, frame_id] : *set) {
+      if (EvictionKey(frames_[frame_id]) != frames_[frame_id].index_key_) {
+        stale.push_back(frame_id);
+      }
+    }
+  }
+  for (frame_id_t frame_id : stale) {
+    UnindexFrame(frame_id);
+    IndexFrame(frame_id);
   }
+  for (auto *set : {&history_set_, &cache_set_}) {
+    for (auto [earliest_access, frame_id] : *set) {
+      if (!visit(frame_id)) {
+        return;
+      }
+    }
+  }
+}
+
+auto LRUKReplacer::EvictionKey(Frame &frame) -> std::pair<bool, size_t> {
+  std::scoped_lock lock(frame.latch_);
+  return {frame.history_size_ >= k_, frame.history_size_ == 0 ? 0 : frame.history_[frame.history_begin_]};
+}
 
-  frames_[frame_id] = nullptr;
-  evictable_size_--;
-  return true;
+void LRUKReplacer::IndexFrame(frame_id_t frame_id) {
+  Frame &frame = frames_[frame_id];
+  frame.index_key_ = EvictionKey(frame);
+  auto &set = frame.index_key_.first ? cache_set_ : history_set_;
+  set.emplace(frame.index_key_.second, frame_id);
 }
 
-auto LRUKReplacer::Size() -> size_t {
-  std::unique_lock lock(mutex_);
-  return evictable_size_;
+void LRUKReplacer::UnindexFrame(frame_id_t frame_id) {
+  Frame &frame = frames_[frame_id];
+  auto &set = frame.index_key_.first ? cache_set_ : history_set_;
+  set.erase({frame.index_key_.second, frame_id});
 }
 
-}  // namespace bustub
\ No newline at end of file
+}  // namespace bustub
@@ -12,18 +12,68 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <vector>
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_frames) { SetPoolSize(num_frames); }
+
+void LRUReplacer::SetPoolSize(size_t pool_size) { frames_.Grow(pool_size); }
 
-LRUReplacer::~LRUReplacer() = default;
+void LRUReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  RecordAccess(frame_id);
+  frame.index_key_ = frame.last_access_;
+  lru_set_.emplace(frame.index_key_, frame_id);
+}
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void LRUReplacer::RecordAccess(frame_id_t frame_id) { frames_[frame_id].last_access_ = ++current_timestamp_; }
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+auto LRUReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  auto it = lru_set_.begin();
+  while (it != lru_set_.end()) {
+    auto [index_key, frame_id] = *it;
+    Frame &frame = frames_[frame_id];
+    size_t last_access = frame.last_access_;
+    if (last_access != frame.index_key_) {
+      // Accessed since it was filed, it moves towards the most recently used end.
+      lru_set_.erase(it);
+      frame.index_key_ = last_access;
+      lru_set_.emplace(last_access, frame_id);
+      it = lru_set_.lower_bound({index_key, frame_id});
+      continue;
+    }
+    if (evictable(frame_id)) {
+      return frame_id;
+    }
+    ++it;
+  }
+  return -1;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id, bool evicted) {
+  lru_set_.erase({frames_[frame_id].index_key_, frame_id});
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  // Refile the frames accessed since they were filed first, or they would be visited where they used to be.
+  std::vector<frame_id_t> stale;
+  for (auto [index_key, frame_id] : lru_set_) {
+    if (frames_[frame_id].last_access_ != index_key) {
+      stale.push_back(frame_id);
+    }
+  }
+  for (frame_id_t frame_id : stale) {
+    Frame &frame = frames_[frame_id];
+    lru_set_.erase({frame.index_key_, frame_id});
+    frame.index_key_ = frame.last_access_;
+    lru_set_.emplace(frame.index_key_, frame_id);
+  }
+  for (auto [index_key, frame_id] : lru_set_) {
+    if (!visit(frame_id)) {
+      return;
+    }
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <utility>
+
+namespace bustub {
+
+PageTable::Table::Table(size_t num_frames) {
+  bits_ = 1;
+  while ((static_cast<size_t>(1) << bits_) < 2 * num_frames) {
+    bits_++;
+  }
+  mask_ = (static_cast<size_t>(1) << bits_) - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(mask_ + 1);
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].store(Pack(EMPTY, -1), std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Table::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing: page ids are mostly consecutive, the high bits of the product spread them over the table.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             (64 - bits_));
+}
+
+PageTable::PageTable(size_t num_frames) {
+  tables_.emplace_back(std::make_unique<Table>(num_frames));
+  table_.store(tables_.back().get());
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+  const Table *table = table_.load(std::memory_order_acquire);
+  size_t slot = table->HomeSlot(page_id);
+  for (size_t probes = 0; probes <= table->mask_; probes++, slot = (slot + 1) & table->mask_) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_acquire);
+    if (PageOf(entry) == page_id) {
+      frame_id = FrameOf(entry);
+      return true;
+    }
+    if (PageOf(entry) == EMPTY) {
+      return false;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != EMPTY && page_id != TOMBSTONE, "invalid page id");
+  InsertInto(table_.load(std::memory_order_relaxed), page_id, frame_id);
+}
+
+void PageTable::InsertInto(Table *table, page_id_t page_id, frame_id_t frame_id) {
+  size_t slot = table->HomeSlot(page_id);
+  size_t free_slot = table->mask_ + 1;
+  for (size_t probes = 0; probes <= table->mask_; probes++, slot = (slot + 1) & table->mask_) {
+    page_id_t slot_page_id = PageOf(table->slots_[slot].load(std::memory_order_relaxed));
+    if (slot_page_id == page_id) {
+      table->slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    if (slot_page_id == TOMBSTONE && free_slot > table->mask_) {
+      free_slot = slot;
+    }
+    if (slot_page_id == EMPTY) {
+      if (free_slot > table->mask_) {
+        free_slot = slot;
+      }
+      break;
+    }
+  }
+  BUSTUB_ASSERT(free_slot <= table->mask_, "page table is full");
+  table->slots_[free_slot].store(Pack(page_id, frame_id), std::memory_order_release);
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  Table *table = table_.load(std::memory_order_relaxed);
+  const size_t mask = table->mask_;
+  auto &slots = table->slots_;
+  size_t slot = table->HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+    page_id_t slot_page_id = PageOf(slots[slot].load(std::memory_order_relaxed));
+    if (slot_page_id == EMPTY) {
+      return false;
+    }
+    if (slot_page_id != page_id) {
+      continue;
+    }
+    if (PageOf(slots[(slot + 1) & mask].load(std::memory_order_relaxed)) != EMPTY) {
+      slots[slot].store(Pack(TOMBSTONE, -1), std::memory_order_release);
+      return true;
+    }
+    // Nothing is probed past an empty slot, so the tombstones right before this one are not needed anymore.
+    do {
+      slots[slot].store(Pack(EMPTY, -1), std::memory_order_release);
+      slot = (slot + mask) & mask;
+    } while (PageOf(slots[slot].load(std::memory_order_relaxed)) == TOMBSTONE);
+    return true;
+  }
+  return false;
+}
+
+void PageTable::Grow(size_t num_frames) {
+  Table *old_table = table_.load(std::memory_order_relaxed);
+  if (2 * num_frames <= old_table->mask_ + 1) {
+    return;
+  }
+  // Fill the new table before publishing it, lookups keep using the old one until then.
+  auto table = std::make_unique<Table>(num_frames);
+  for (size_t i = 0; i <= old_table->mask_; i++) {
+    uint64_t entry = old_table->slots_[i].load(std::memory_order_relaxed);
+    if (PageOf(entry) != EMPTY && PageOf(entry) != TOMBSTONE) {
+      InsertInto(table.get(), PageOf(entry), FrameOf(entry));
+    }
+  }
+  table_.store(table.get(), std::memory_order_release);
+  tables_.emplace_back(std::move(table));
+}
+
+}  // namespace bustub
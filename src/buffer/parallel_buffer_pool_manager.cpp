@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <string>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "ParallelBufferPoolManager needs at least one instance");
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, replacer_type));
+  }
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t new_size) -> bool {
+  const size_t num_instances = instances_.size();
+  if (new_size < num_instances || (new_size + num_instances - 1) / num_instances > BUFFER_POOL_MAX_FRAMES) {
+    return false;
+  }
+  // The first new_size % num_instances instances get one frame more.
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_[i]->Resize(new_size / num_instances + (i < new_size % num_instances ? 1 : 0));
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  // Get BufferPoolManager responsible for handling given page id.
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, strategy);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, page_id_t segment) -> Page * {
+  // Try every instance once, starting from the next one in round robin order, and return the first page that could
+  // be created. The starting index moves on every call whether or not the allocation succeeds.
+  size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); i++) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPage(page_id, segment);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto &instance : instances_) {
+    instance->WriteDirtyPages();
+  }
+  disk_manager_->SyncPages();
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(size_t batch_size, double dirty_ratio) {
+  for (auto &instance : instances_) {
+    instance->StartPageCleaner(batch_size, dirty_ratio);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto &instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> batches(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    batches[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instances_[i]->PrefetchPages(batches[i]);
+  }
+}
+
+auto ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) -> bool {
+  std::vector<std::vector<page_id_t>> batches(instances_.size());
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    size_t instance = static_cast<size_t>(page_ids[i]) % instances_.size();
+    batches[instance].push_back(page_ids[i]);
+    positions[instance].push_back(i);
+  }
+  bool fetched_all = true;
+  std::vector<Page *> fetched;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (batches[i].empty()) {
+      continue;
+    }
+    fetched.resize(batches[i].size());
+    fetched_all = instances_[i]->FetchPages(batches[i], fetched.data()) && fetched_all;
+    for (size_t j = 0; j < fetched.size(); j++) {
+      pages[positions[i][j]] = fetched[j];
+    }
+  }
+  return fetched_all;
+}
+
+auto ParallelBufferPoolManager::DumpPool(const std::string &dump_file) -> bool {
+  bool dumped = true;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    dumped = instances_[i]->DumpPool(dump_file + "." + std::to_string(i)) && dumped;
+  }
+  return dumped;
+}
+
+auto ParallelBufferPoolManager::WarmUp(const std::string &dump_file) -> size_t {
+  size_t loaded = 0;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    loaded += instances_[i]->WarmUp(dump_file + "." + std::to_string(i));
+  }
+  return loaded;
+}
+
+void ParallelBufferPoolManager::Print() {
+  for (auto &instance : instances_) {
+    instance->Print();
+  }
+}
+
+}  // namespace bustub
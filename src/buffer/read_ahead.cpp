@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <vector>
+
+namespace bustub {
+
+void ReadAhead::Advance(page_id_t next_page_id) {
+  if (window_ == 0 || next_page_id == INVALID_PAGE_ID) {
+    pages_.clear();
+    return;
+  }
+  // Forget the pages the scan has passed. If it left the list we knew about, start over from the next page.
+  while (!pages_.empty() && pages_.front() != next_page_id) {
+    pages_.pop_front();
+  }
+  std::vector<page_id_t> page_ids;
+  if (pages_.empty()) {
+    pages_.push_back(next_page_id);
+    page_ids.push_back(next_page_id);
+  } else if (pages_.size() < window_) {
+    Page *page = bpm_->FetchPage(pages_.back());
+    if (page != nullptr) {
+      page->RLatch();
+      page_id_t page_id = next_page_(page);
+      page->RUnlatch();
+      bpm_->UnpinPage(page->GetPageId(), false);
+      if (page_id != INVALID_PAGE_ID) {
+        pages_.push_back(page_id);
+        page_ids.push_back(page_id);
+      }
+    }
+  }
+  bpm_->PrefetchPages(page_ids);
+}
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+auto CreateReplacer(ReplacerType type, size_t replacer_k) -> std::unique_ptr<Replacer> {
+  switch (type) {
+    case ReplacerType::LRU_K:
+      return std::make_unique<LRUKReplacer>(0, replacer_k);
+    case ReplacerType::LRU:
+      return std::make_unique<LRUReplacer>(0);
+    case ReplacerType::CLOCK:
+      return std::make_unique<ClockReplacer>(0);
+    case ReplacerType::ARC:
+      return std::make_unique<ARCReplacer>(0);
+    case ReplacerType::TWO_QUEUE:
+      return std::make_unique<TwoQueueReplacer>(0);
+    case ReplacerType::CLOCK_PRO:
+      return std::make_unique<ClockProReplacer>(0);
+  }
+  throw Exception(ExceptionType::INVALID, "unknown replacer type");
+}
+
+auto ReplacerTypeToString(ReplacerType type) -> std::string {
+  switch (type) {
+    case ReplacerType::LRU_K:
+      return "LRU-K";
+    case ReplacerType::LRU:
+      return "LRU";
+    case ReplacerType::CLOCK:
+      return "CLOCK";
+    case ReplacerType::ARC:
+      return "ARC";
+    case ReplacerType::TWO_QUEUE:
+      return "2Q";
+    case ReplacerType::CLOCK_PRO:
+      return "CLOCK-Pro";
+  }
+  return "unknown";
+}
+
+}  // namespace bustub
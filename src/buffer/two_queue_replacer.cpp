@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames) { SetPoolSize(num_frames); }
+
+void TwoQueueReplacer::SetPoolSize(size_t pool_size) {
+  frames_.Grow(pool_size);
+  kin_ = std::max<size_t>(1, pool_size / 4);
+  kout_ = std::max<size_t>(1, pool_size / 2);
+}
+
+void TwoQueueReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Frame &frame = frames_[frame_id];
+  frame.page_id_ = page_id;
+  RecordAccess(frame_id);
+
+  auto ghost = a1out_index_.find(page_id);
+  if (ghost == a1out_index_.end()) {
+    frame.in_am_ = false;
+    frame.position_ = a1in_.insert(a1in_.end(), frame_id);
+    return;
+  }
+  a1out_.erase(ghost->second);
+  a1out_index_.erase(ghost);
+  frame.in_am_ = true;
+  frame.index_key_ = frame.last_access_;
+  am_.emplace(frame.index_key_, frame_id);
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id) { frames_[frame_id].last_access_ = ++current_timestamp_; }
+
+auto TwoQueueReplacer::Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  frame_id_t frame_id = -1;
+  if (a1in_.size() > kin_) {
+    frame_id = A1inVictim(evictable);
+  }
+  if (frame_id == -1) {
+    frame_id = AmVictim(evictable);
+  }
+  if (frame_id == -1) {
+    frame_id = A1inVictim(evictable);
+  }
+  return frame_id;
+}
+
+auto TwoQueueReplacer::A1inVictim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  for (frame_id_t frame_id : a1in_) {
+    if (evictable(frame_id)) {
+      return frame_id;
+    }
+  }
+  return -1;
+}
+
+auto TwoQueueReplacer::AmVictim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t {
+  auto it = am_.begin();
+  while (it != am_.end()) {
+    auto [index_key, frame_id] = *it;
+    Frame &frame = frames_[frame_id];
+    size_t last_access = frame.last_access_;
+    if (last_access != frame.index_key_) {
+      am_.erase(it);
+      frame.index_key_ = last_access;
+      am_.emplace(last_access, frame_id);
+      it = am_.lower_bound({index_key, frame_id});
+      continue;
+    }
+    if (evictable(frame_id)) {
+      return frame_id;
+    }
+    ++it;
+  }
+  return -1;
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id, bool evicted) {
+  Frame &frame = frames_[frame_id];
+  if (frame.in_am_) {
+    am_.erase({frame.index_key_, frame_id});
+    return;
+  }
+  a1in_.erase(frame.position_);
+  if (!evicted) {
+    return;
+  }
+  a1out_index_[frame.page_id_] = a1out_.insert(a1out_.end(), frame.page_id_);
+  while (a1out_.size() > kout_) {
+    a1out_index_.erase(a1out_.front());
+    a1out_.pop_front();
+  }
+}
+
+void TwoQueueReplacer::ForEach(const std::function<bool(frame_id_t)> &visit) {
+  // Refile the frames of Am accessed since they were filed first, or they would be visited where they used to be.
+  std::vector<frame_id_t> stale;
+  for (auto [index_key, frame_id] : am_) {
+    if (frames_[frame_id].last_access_ != index_key) {
+      stale.push_back(frame_id);
+    }
+  }
+  for (frame_id_t frame_id : stale) {
+    Frame &frame = frames_[frame_id];
+    am_.erase({frame.index_key_, frame_id});
+    frame.index_key_ = frame.last_access_;
+    am_.emplace(frame.index_key_, frame_id);
+  }
+  for (frame_id_t frame_id : a1in_) {
+    if (!visit(frame_id)) {
+      return;
+    }
+  }
+  for (auto [index_key, frame_id] : am_) {
+    if (!visit(frame_id)) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -53,7 +53,13 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    auto *bpm = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    // Write dirty pages back in the background, so that misses on the database file mostly find clean victims.
+    bpm->StartPageCleaner();
+    // Start warm: reload the pages that were resident at the last clean shutdown.
+    pool_dump_file_ = db_file_name.substr(0, db_file_name.rfind('.')) + ".pool";
+    bpm->WarmUp(pool_dump_file_);
+    buffer_pool_manager_ = bpm;
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -159,6 +165,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\stats: show the buffer pool counters
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -172,6 +179,36 @@ see the execution plan of your query.
   WriteOneCell(help, writer);
 }
 
+void BustubInstance::CmdDisplayStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  auto stats = buffer_pool_manager_->GetStats();
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("stat");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  auto write_row = [&writer](const std::string &name, const std::string &value) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  };
+  write_row("pool_size", fmt::format("{}", buffer_pool_manager_->GetPoolSize()));
+  write_row("hits", fmt::format("{}", stats.hits_));
+  write_row("misses", fmt::format("{}", stats.misses_));
+  write_row("hit_ratio", fmt::format("{:.4f}", stats.HitRatio()));
+  write_row("new_pages", fmt::format("{}", stats.new_pages_));
+  write_row("evictions", fmt::format("{}", stats.evictions_));
+  write_row("dirty_evictions", fmt::format("{}", stats.dirty_evictions_));
+  write_row("flushes", fmt::format("{}", stats.flushes_));
+  write_row("pinned_failures", fmt::format("{}", stats.pinned_failures_));
+  write_row("read_time_us", fmt::format("{}", stats.read_time_us_));
+  write_row("write_time_us", fmt::format("{}", stats.write_time_us_));
+  writer.EndTable();
+}
+
 auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
   auto txn = txn_manager_->Begin();
   auto result = ExecuteSqlTxn(sql, writer, txn);
@@ -195,6 +232,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayHelp(writer);
       return true;
     }
+    if (sql == "\\stats") {
+      CmdDisplayStats(writer);
+      return true;
+    }
     throw Exception(fmt::format("unsupported internal command: {}", sql));
   }
 
@@ -395,6 +436,9 @@ BustubInstance::~BustubInstance() {
   delete catalog_;
   delete checkpoint_manager_;
   delete log_manager_;
+  if (buffer_pool_manager_ != nullptr && !pool_dump_file_.empty()) {
+    buffer_pool_manager_->DumpPool(pool_dump_file_);
+  }
   delete buffer_pool_manager_;
   delete lock_manager_;
   delete txn_manager_;
@@ -22,7 +22,7 @@ auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oi
   bool upgrade = false;
   LockRequest *request = new LockRequest(txn->GetTransactionId(), lock_mode, oid);
 
-  while(!txn->GetState() == TransactionState::ABORTED) {
+  while(txn->GetState() != TransactionState::ABORTED) {
     std::unique_lock<std::mutex> table_lock_map_lk(table_lock_map_mutex_);
     if (auto search =  table_lock_map_.find(oid); search != table_lock_map_.end()){
       std::shared_ptr<LockRequestQueue> lock_request_queue = search->second;
@@ -125,7 +125,7 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
   bool upgrade = false;
   LockRequest *request = new LockRequest(txn->GetTransactionId(), lock_mode, oid, rid);
 
-  while(!txn->GetState() == TransactionState::ABORTED) {
+  while(txn->GetState() != TransactionState::ABORTED) {
     std::unique_lock<std::mutex> row_lock_map_lk(row_lock_map_mutex_);
     if (auto search =  row_lock_map_.find(rid); search != row_lock_map_.end()){
       std::shared_ptr<LockRequestQueue> lock_request_queue = search->second;
@@ -29,27 +29,41 @@ void NestIndexJoinExecutor::Init() {
   index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
   index_table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetIndexTableOid());
   index_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info_->index_.get());
-
+  outer_tuples_.clear();
+  matches_.clear();
+  batch_cursor_ = 0;
 }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
-
+auto NestIndexJoinExecutor::NextBatch() -> bool {
+  outer_tuples_.clear();
+  batch_cursor_ = 0;
+  const auto *key_predicate_expr = dynamic_cast<const ColumnValueExpression *>(plan_->KeyPredicate().get());
+  std::vector<Tuple> key_tuples;
   Tuple inner_tuple;
   RID inner_rid;
+  while (outer_tuples_.size() < static_cast<size_t>(INDEX_JOIN_BATCH_SIZE) &&
+         child_executor_->Next(&inner_tuple, &inner_rid)) {
+    // Tuple tuple = inner_tuple.KeyFromTuple(table_info->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
+    std::vector<Value> key_values{key_predicate_expr->Evaluate(&inner_tuple, child_executor_->GetOutputSchema())};
+    key_tuples.emplace_back(key_values, index_->GetKeySchema());
+    outer_tuples_.push_back(inner_tuple);
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
+  index_->ScanKeys(key_tuples, &matches_, exec_ctx_->GetTransaction());
+  return true;
+}
 
-  
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { 
   while(true){
-    if(!child_executor_->Next(&inner_tuple, &inner_rid)){
+    if (batch_cursor_ == outer_tuples_.size() && !NextBatch()) {
       return false;
     }
-    std::vector<RID> result;
-    std::vector<Value> key_values;
-    // Tuple tuple = inner_tuple.KeyFromTuple(table_info->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
+    const Tuple &inner_tuple = outer_tuples_[batch_cursor_];
+    const std::vector<RID> &result = matches_[batch_cursor_];
+    batch_cursor_++;
     const auto *key_predicate_expr = dynamic_cast<const ColumnValueExpression *>(plan_->KeyPredicate().get());
-    Value value = key_predicate_expr->Evaluate(&inner_tuple, child_executor_->GetOutputSchema());
-    key_values.emplace_back(value);
-    Tuple key_tuple(key_values, index_->GetKeySchema());
-    index_->ScanKey(key_tuple, &result, exec_ctx_->GetTransaction());
     if(result.size() > 0){
       Tuple index_tuple;
       index_table_info_->table_->GetTuple(result[0], &index_tuple, exec_ctx_->GetTransaction(), true);
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+#include "buffer/frame_array.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy, in its CLOCK with Adaptive Replacement (CAR) form.
+ *
+ * Resident pages are split between T1, the pages seen once recently, and T2, the pages seen at least twice. B1 and B2
+ * remember the ids of the pages recently evicted from T1 and T2. A miss on a page of B1 means T1 is too small and
+ * grows its target size p, a miss on a page of B2 shrinks it. Victims are taken from T1 while it is larger than p,
+ * from T2 otherwise.
+ *
+ * ARC moves a page to the head of T2 on every hit, which would need the pool latch. CAR keeps T1 and T2 as clocks
+ * instead: a hit only sets the reference bit of its frame, and the hand of T1 moves the referenced pages it passes
+ * over to T2. CAR tracks ARC's hit ratio closely.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * @param num_frames the initial number of frames, see SetPoolSize()
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ARCReplacer);
+
+  ~ARCReplacer() override = default;
+
+  /** The cache size c of the policy: T1 and T2 hold up to c pages, B1 and B2 as many. */
+  void SetPoolSize(size_t pool_size) override;
+
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
+
+  /** An evicted page is remembered in B1 or B2, depending on where it was. */
+  void Remove(frame_id_t frame_id, bool evicted) override;
+
+  /** Visit T1, then T2, from their hands on. */
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
+
+  /** @return the target size of T1 */
+  auto GetTarget() const -> size_t { return p_; }
+
+ private:
+  struct Frame {
+    /** The reference bit, set by buffer hits without the pool latch. */
+    std::atomic<bool> ref_{false};
+    /** The page held by the frame. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** True if the frame is in T2, false if it is in T1. */
+    bool in_t2_{false};
+    /** The position of the frame in its clock. */
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** A page remembered in B1 or B2. */
+  struct Ghost {
+    bool in_b2_;
+    std::list<page_id_t>::iterator position_;
+  };
+
+  /** Drop the least recently evicted page of B1 or B2. */
+  void DropGhost(bool from_b2);
+
+  size_t c_{0};
+  /** The target size of T1. */
+  size_t p_{0};
+  FrameArray<Frame> frames_;
+  /** The clocks, the hand is the front: pages are looked at from the front and go in at the back. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** The ghost lists, least recently evicted page first. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, Ghost> ghosts_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy is a small private ring of frames for a bulk read such as a sequential scan, in the spirit of
+ * the BULKREAD ring of Postgres. Pages the scan misses on are read into the frames of its ring, recycling them once
+ * the ring is full, instead of evicting the pages the rest of the workload keeps hot. Fetches through a strategy do
+ * not count as accesses for LRU-K either, so that a scan touching a page once per tuple cannot promote it.
+ *
+ * A frame only stays in the ring while nobody else uses it. Once another fetch records an access to it, the buffer
+ * pool stops recycling it and the ring slot picks up a regular victim next time.
+ *
+ * A strategy belongs to a single query and is not thread safe.
+ */
+class BufferAccessStrategy {
+ public:
+  /** @param ring_size number of frames in the ring */
+  explicit BufferAccessStrategy(size_t ring_size = BULK_READ_RING_SIZE) : ring_(ring_size, nullptr) {
+    BUSTUB_ASSERT(ring_size > 0, "the ring of a buffer access strategy cannot be empty");
+  }
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return the number of frames in the ring */
+  auto GetRingSize() const -> size_t { return ring_.size(); }
+
+  /**
+   * Move on to the next slot of the ring.
+   * @return the frame in that slot, nullptr if the slot is still empty
+   */
+  auto Next() -> Page * {
+    current_ = (current_ + 1) % ring_.size();
+    return ring_[current_];
+  }
+
+  /** Put a frame into the current slot of the ring, replacing the one it held. */
+  void SetCurrent(Page *frame) { ring_[current_] = frame; }
+
+ private:
+  /** Frames of the ring, nullptr for the slots that were never filled. */
+  std::vector<Page *> ring_;
+  /** The slot last returned by Next(). */
+  size_t current_{0};
+};
+
+}  // namespace bustub
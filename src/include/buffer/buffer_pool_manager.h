@@ -14,15 +14,60 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/**
+ * BufferPoolStats is a snapshot of the counters of a buffer pool, from when it was created.
+ */
+struct BufferPoolStats {
+  /** Fetches that found the page in the buffer pool. */
+  uint64_t hits_{0};
+  /** Fetches that read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages created by NewPage(). */
+  uint64_t new_pages_{0};
+  /** Pages evicted to make room for another one, or by a shrinking Resize(). */
+  uint64_t evictions_{0};
+  /** Evictions that wrote the page back first. */
+  uint64_t dirty_evictions_{0};
+  /** Pages written back by FlushPage(), FlushAllPages() or the page cleaner. */
+  uint64_t flushes_{0};
+  /** Fetches and new pages that failed because every frame was pinned. */
+  uint64_t pinned_failures_{0};
+  /** Time spent in disk reads and writes, in microseconds. */
+  uint64_t read_time_us_{0};
+  uint64_t write_time_us_{0};
+
+  /** @return the fraction of fetches that found the page in the buffer pool, 0 if there were none */
+  auto HitRatio() const -> double {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    new_pages_ += other.new_pages_;
+    evictions_ += other.evictions_;
+    dirty_evictions_ += other.dirty_evictions_;
+    flushes_ += other.flushes_;
+    pinned_failures_ += other.pinned_failures_;
+    read_time_us_ += other.read_time_us_;
+    write_time_us_ += other.write_time_us_;
+    return *this;
+  }
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -40,11 +85,22 @@ class BufferPoolManager {
   /** Grading function. Do not modify! */
   auto FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> Page * {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPgImp(page_id);
+    auto *result = FetchPgImp(page_id, nullptr);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
 
+  /**
+   * Fetch a page on behalf of a bulk read. A miss reads the page into a frame of the strategy's ring instead of
+   * evicting a page the rest of the workload uses, see BufferAccessStrategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the scan, nullptr for a regular fetch
+   * @return the requested page
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+    return FetchPgImp(page_id, strategy);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -64,11 +120,19 @@ class BufferPoolManager {
   /** Grading function. Do not modify! */
   auto NewPage(page_id_t *page_id, bufferpool_callback_fn callback = nullptr) -> Page * {
     GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
-    auto *result = NewPgImp(page_id);
+    auto *result = NewPgImp(page_id, INVALID_PAGE_ID);
     GradingCallback(callback, CallbackType::AFTER, *page_id);
     return result;
   }
 
+  /**
+   * Create a new page of a table or index, in the extents of its segment, see DiskManager::AllocatePage().
+   * @param[out] page_id id of created page
+   * @param segment any page of the table or index, NEW_SEGMENT for its first page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, page_id_t segment) -> Page * { return NewPgImp(page_id, segment); }
+
   /** Grading function. Do not modify! */
   auto DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -84,9 +148,118 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page, pinned by the returned guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk read, nullptr for a regular fetch
+   * @return a guard of the page, empty if the page could not be fetched
+   */
+  auto FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) -> BasicPageGuard {
+    return {this, FetchPgImp(page_id, strategy)};
+  }
+
+  /**
+   * Fetch a page and take its read latch, both held by the returned guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk read, nullptr for a regular fetch
+   * @return a guard of the page, empty if the page could not be fetched
+   */
+  auto FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) -> ReadPageGuard {
+    Page *page = FetchPgImp(page_id, strategy);
+    if (page != nullptr) {
+      page->RLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Fetch a page and take its write latch, both held by the returned guard.
+   * @param page_id id of page to be fetched
+   * @return a guard of the page, empty if the page could not be fetched
+   */
+  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard {
+    Page *page = FetchPgImp(page_id, nullptr);
+    if (page != nullptr) {
+      page->WLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Create a new page, pinned by the returned guard.
+   * @param[out] page_id id of created page
+   * @param segment any page of the table or index the page is for, NEW_SEGMENT for its first page, INVALID_PAGE_ID
+   * for a page of no segment
+   * @return a guard of the page, empty if no new page could be created
+   */
+  auto NewPageGuarded(page_id_t *page_id, page_id_t segment = INVALID_PAGE_ID) -> BasicPageGuard {
+    return {this, NewPgImp(page_id, segment)};
+  }
+
+  /**
+   * Hint that the given pages are about to be fetched. They are read into the buffer pool in the background and left
+   * unpinned. Pages that are already in the buffer pool, or that find every frame pinned, are skipped.
+   * @param page_ids ids of the pages to read ahead, in the order they will be fetched
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids) = 0;
+
+  /**
+   * Fetch several pages at once, each one pinned as by FetchPage(). The pool latch is taken once for all the misses,
+   * and they are read with one disk request per run of pages that are next to each other on disk.
+   * @param page_ids ids of the pages to fetch, a page listed twice is pinned twice
+   * @param[out] pages the fetched pages, in the order of page_ids. The ones that found every frame pinned are nullptr,
+   * the others are pinned either way.
+   * @return true if every page was fetched
+   */
+  virtual auto FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) -> bool = 0;
+
+  /**
+   * Unpin the pages fetched by FetchPages(). Unpins take no pool latch, so there is nothing to amortize beyond the
+   * call itself.
+   * @param page_ids ids of the pages to unpin, a page listed twice is unpinned twice
+   * @param is_dirty true if the pages should be marked as dirty
+   * @return false if one of the pages was not pinned
+   */
+  auto UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+    bool unpinned = true;
+    for (page_id_t page_id : page_ids) {
+      unpinned = UnpinPgImp(page_id, is_dirty) && unpinned;
+    }
+    return unpinned;
+  }
+
+  /**
+   * Write the ids of the resident pages to a side file, in the order the replacer would evict them, so that a restart
+   * can warm the buffer pool up with WarmUp() instead of starting cold. Page data is not written, only the list of
+   * pages.
+   * @param dump_file the file to write
+   * @return false if the file could not be written
+   */
+  virtual auto DumpPool(const std::string &dump_file) -> bool = 0;
+
+  /**
+   * Load the pages listed by DumpPool() into the free frames, with one disk read per run of consecutive pages, and
+   * hand them to the replacer in the order they were dumped. Meant to be called at startup, before the buffer pool
+   * serves any traffic. Pages that are already resident are skipped, and no page is evicted.
+   * @param dump_file the file written by DumpPool()
+   * @return the number of pages loaded, 0 if the file is missing or unreadable
+   */
+  virtual auto WarmUp(const std::string &dump_file) -> size_t = 0;
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return the counters of the buffer pool, they can be read at any time without stopping it */
+  virtual auto GetStats() -> BufferPoolStats = 0;
+
+  /**
+   * Change the number of frames of the buffer pool while queries run. Growing adds free frames, shrinking evicts the
+   * pages above the new size as soon as they are unpinned, and waits for it. The caller must not hold any pin.
+   * @param new_size the new size of the buffer pool
+   * @return false if the buffer pool cannot have that size
+   */
+  virtual auto Resize(size_t new_size) -> bool = 0;
+
   // ===================== for test ============================
   virtual void Print() = 0;
   virtual auto GetFrames() -> Page* = 0;
@@ -107,9 +280,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk read, nullptr for a regular fetch
    * @return the requested page
    */
-  virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -129,9 +303,10 @@ class BufferPoolManager {
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param segment the segment to allocate the page in, INVALID_PAGE_ID for none, see DiskManager::AllocatePage()
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
+  virtual auto NewPgImp(page_id_t *page_id, page_id_t segment) -> Page * = 0;
 
   /**
    * Deletes a page from the buffer pool.
@@ -12,16 +12,27 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -37,9 +48,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,9 +75,67 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @return a snapshot of the counters, each one read atomically */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * @brief Change the number of frames of the buffer pool while it is in use.
+   *
+   * Growing adds frames to the free list. Shrinking takes the frames above new_size out of use: free ones are released
+   * right away, the others are drained, i.e. evicted as soon as they are unpinned, dirty pages being written back
+   * first. Resize() returns once every one of them is released, so the caller must not hold pins of its own.
+   *
+   * @param new_size the new number of frames, at most BUFFER_POOL_MAX_FRAMES
+   * @return false if new_size is 0 or too large
+   */
+  auto Resize(size_t new_size) -> bool override;
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetFrames() -> Page * override { return pages_; }
 
+  /**
+   * @brief Start the background page cleaner. Every page_cleaner_interval, or sooner when a miss had to write back a
+   * dirty victim itself, it writes back the dirty unpinned frames among the next `batch_size` victims. While more
+   * than `dirty_ratio` of the pool is dirty and unpinned, it keeps going further down the replacement order, up to
+   * `batch_size` pages per round.
+   * @param batch_size max number of pages written back per round
+   * @param dirty_ratio fraction of the pool that may stay dirty
+   */
+  void StartPageCleaner(size_t batch_size = PAGE_CLEANER_BATCH_SIZE, double dirty_ratio = PAGE_CLEANER_DIRTY_RATIO);
+
+  /** @brief Stop the background page cleaner, if it is running. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Write back the dirty pages in page id order, a run of pages that are next to each other on disk with a
+   * single DiskManager::WritePages(). Clean pages are skipped. The writes are not synced, see FlushAllPgsImp().
+   * @return the number of pages written
+   */
+  auto WriteDirtyPages() -> size_t;
+
+  /**
+   * @brief Queue the pages for the prefetcher thread, which is started on first use. It loads what is queued in
+   * batches through FetchPages(), with the reads of a batch in flight together, and unpins them right away.
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Pin the resident pages without the pool latch, like FetchPgImp() does, then map a frame for each miss under
+   * a single acquisition of the latch. The misses are read after the latch is released, a run of pages that are next
+   * to each other on disk with a single ReadPages().
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) -> bool override;
+
+  /** @brief Write the ids of the resident pages to dump_file, in the order the replacer would evict them. */
+  auto DumpPool(const std::string &dump_file) -> bool override;
+
+  /**
+   * @brief Load the pages of dump_file that belong to this instance into the free frames. If there are more than the
+   * pool holds, the ones that would have been evicted last are kept. They are handed to the replacer in the order
+   * they were dumped, so that they keep their relative order.
+   */
+  auto WarmUp(const std::string &dump_file) -> size_t override;
+
  // ==================== for test ================
 
   void Print() override;
@@ -72,9 +156,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
    * @param[out] page_id id of created page
+   * @param segment the segment to allocate the page in, INVALID_PAGE_ID for none
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPgImp(page_id_t *page_id) -> Page * override;
+  auto NewPgImp(page_id_t *page_id, page_id_t segment) -> Page * override;
 
   /**
    * @brief Fetch the requested page from the buffer pool. Return nullptr if page_id needs to be fetched from the disk
@@ -87,10 +172,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPgImp().
    *
+   * With a strategy, a miss recycles the frame in the next slot of the strategy's ring if it is still private to the
+   * ring, and the fetch is not recorded in the access history of a page that is already in the pool.
+   *
    * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk read, nullptr for a regular fetch
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
-  auto FetchPgImp(page_id_t page_id) -> Page * override;
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +210,8 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /**
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the dirty pages in the buffer pool to disk with WriteDirtyPages(), then make them durable with
+   * a single DiskManager::SyncPages().
    */
   void FlushAllPgsImp() override;
 
@@ -142,51 +232,203 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
 
 private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  page_id_t next_page_id_ {0};
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
-
-  /** Array of buffer pool pages. */
+  /** First word of a file written by DumpPool(). */
+  static constexpr uint32_t POOL_DUMP_MAGIC = 0x504F4F32;
+
+  /** Number of pages in the buffer pool. Frames from pool_size_ up are released, or being drained by Resize(). */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames ever set up, protected by mutex_. They stay valid until the buffer pool is destroyed. */
+  size_t num_frames_{0};
+  /** Serializes Resize() calls. */
+  std::mutex resize_mutex_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+
+  /**
+   * Array of buffer pool pages. Room for BUFFER_POOL_MAX_FRAMES frames is reserved up front so that the frames never
+   * move: buffer hits index it without the pool latch. Only the frames in use take memory.
+   */
   Page *pages_;
+  /**
+   * The data of the frames, BUSTUB_PAGE_SIZE bytes each at frame_data_ + frame_id * BUSTUB_PAGE_SIZE. It is reserved
+   * for BUFFER_POOL_MAX_FRAMES frames in one mapping of its own, starting on a huge page boundary, so that every frame
+   * is aligned on BUSTUB_PAGE_SIZE and a large pool takes few TLB entries.
+   */
+  char *frame_data_;
+  /** The mapping frame_data_ is carved from, a bit larger than the frames need for the alignment. */
+  char *frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_;
+  /**
+   * Runs the page reads and writes of the pool that come in batches, so that they are all in flight at once. A lone
+   * read or write the caller waits for is done inline, a hand-off would only add latency to it.
+   */
+  DiskScheduler disk_scheduler_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups take no latch, updates are done under mutex_. */
+  PageTable page_table_;
   // ReaderWriterLatch page_table_latch_;
-  /** Replacer to find unpinned pages for replacement. */
-  // LRUKReplacer *replacer_;
+  /** Replacer to find unpinned pages for replacement, protected by mutex_ except for its RecordAccess(). */
+  std::unique_ptr<Replacer> replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
   ReaderWriterLatch free_list_latch_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * The pool latch. It protects the page table updates, the free list, the replacer, and the mapping of frames
+   * to pages. It is never held across disk I/O: a frame being read or written is pinned so that it stays put, and the
+   * reader holds the frame_mutex_ of the frame instead.
+   *
+   * Buffer hits and unpins do not take it. A hit looks the page up in the page table, pins the frame with a
+   * compare-and-swap on its pin count, then checks that the frame still holds the page. Frames are only mapped or
+   * unmapped while claimed (pin count FRAME_CLAIMED), which no pin can get past, and the claim is only taken on an
+   * unpinned frame. Under the latch, a frame in the page table is never claimed.
+   */
   std::mutex mutex_;
   // ReaderWriterLatch latch_;
 
   std::mutex mutex2_;
   
-  std::atomic<size_t> current_timestamp_{0};
-  
+  /** The background page cleaner, see StartPageCleaner(). */
+  std::thread *cleaner_thread_{nullptr};
+  bool enable_cleaner_{false};
+  size_t cleaner_batch_size_{PAGE_CLEANER_BATCH_SIZE};
+  double cleaner_dirty_ratio_{PAGE_CLEANER_DIRTY_RATIO};
+  /** Wakes up the page cleaner, waited on with mutex_. */
+  std::condition_variable cleaner_cv_;
+
+  /** Pages waiting to be prefetched, protected by mutex_. */
+  std::deque<page_id_t> prefetch_queue_;
+  std::thread *prefetch_thread_{nullptr};
+  bool enable_prefetcher_{false};
+  /** Wakes up the prefetcher, waited on with mutex_. */
+  std::condition_variable prefetch_cv_;
+
+  /** The counters behind GetStats(). Buffer hits update them without the pool latch. */
+  struct Counters {
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> new_pages_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> dirty_evictions_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> pinned_failures_{0};
+    std::atomic<uint64_t> read_time_us_{0};
+    std::atomic<uint64_t> write_time_us_{0};
+  };
+  Counters stats_;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing a deallocated one if there is any. Caller should acquire the latch before
+   * calling this function. Ids are taken from the stripe page_id % num_instances_ == instance_index_ so that they stay
+   * unique across the instances of a parallel BPM.
+   * @param segment the segment to allocate the page in, INVALID_PAGE_ID for none, see DiskManager::AllocatePage()
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(page_id_t segment = INVALID_PAGE_ID) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, its id may be handed out again by AllocatePage(). Caller should acquire the
+   * latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+  /**
+   * @brief Ask the replacer for an unpinned frame to evict. The victim is not claimed, it may be pinned again as soon
+   * as this returns. Caller should acquire the latch.
+   * @return the id of the victim frame, -1 if every frame is pinned
+   */
+  auto Victim() -> frame_id_t;
+
+  /**
+   * @brief Pin a page if it is resident, without the pool latch. The page may still be being read in.
+   * @return the id of its frame, -1 if the page is not in the buffer pool
+   */
+  auto PinResident(page_id_t page_id) -> frame_id_t;
+
+  /**
+   * @brief Read pages into the frames just mapped to them, which are pinned and hold their frame_mutex_, then release
+   * the frame_mutex_ of each. Runs of pages that are next to each other on disk are read with a single ReadPages(),
+   * the other pages are all read at once by the disk scheduler. Caller should not hold the latch.
+   * @param mapped the pages and their frames, sorted by page id
+   */
+  void LoadPages(const std::vector<std::pair<page_id_t, frame_id_t>> &mapped);
+
+  /**
+   * @brief Read or write a page through the disk scheduler.
+   * @return the future of the request, true once it has completed
+   */
+  auto ScheduleIo(bool is_write, page_id_t page_id, char *data) -> std::future<bool>;
+
+  /**
+   * @brief Take a frame from the free list, or evict one and drop its page table entry. A dirty victim is written
+   * back with the latch released, so `lock` may be unlocked and relocked in between.
+   * @param lock the caller's lock on mutex_
+   * @param strategy if not nullptr, the frame in the next slot of its ring is recycled first when it can be, and the
+   * frame returned goes into that slot
+   * @return the id of an unmapped, claimed frame, -1 if every frame is pinned
+   */
+  auto AcquireFrame(std::unique_lock<std::mutex> *lock, BufferAccessStrategy *strategy = nullptr) -> frame_id_t;
+
+  /**
+   * @brief Look at the frame of the next ring slot, which can be recycled if it belongs to this instance, is
+   * unpinned, and nobody but the ring has accessed its page. Caller should hold mutex_.
+   * @return the id of the frame, -1 if it cannot be recycled
+   */
+  auto RingVictim(BufferAccessStrategy *strategy) -> frame_id_t;
+
+  /**
+   * @brief Drop one pin of the frame, then free it if that was the last pin and its deletion was delayed. Caller
+   * should hold mutex_.
+   */
+  void UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Drop one pin of the frame without the latch. If that was the last pin and the deletion of the page was
+   * delayed, take the latch and free the frame.
+   * @return false if the frame was not pinned
+   */
+  auto ReleasePin(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Unmap a claimed frame, drop it from the replacer and put it back on the free list. Caller should
+   * hold mutex_.
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Put an unmapped, claimed frame on the free list, or release it if the pool has shrunk below it. Caller
+   * should hold mutex_.
+   */
+  void PutFreeFrame(frame_id_t frame_id);
 
-  auto Victim() -> frame_id_t ;
+  /**
+   * @brief Evict the page of an unpinned frame, writing it back first if it is dirty. A dirty page is written back
+   * with the latch released, so `lock` may be unlocked and relocked in between. Caller should hold `lock`.
+   * @return true if the frame is now unmapped and claimed, false if it was pinned in the meantime
+   */
+  auto EvictFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Set up frames and put them on the free list until the pool has new_size frames. Caller should hold mutex_.
+   */
+  void AddFrames(size_t new_size);
+
+  /** @brief Body of the page cleaner thread. */
+  void RunPageCleaner();
+
+  /** @brief Body of the prefetcher thread. */
+  void RunPrefetcher();
+
+  /**
+   * @brief Write back one batch of dirty frames from the tail of the replacement order, with all the writes in flight
+   * together. Caller should hold `lock`, which is released during the writes.
+   * @return the number of pages written back
+   */
+  auto CleanPages(std::unique_lock<std::mutex> *lock) -> size_t;
   // auto Evict() -> frame_id_t;
 };
 
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+#include "buffer/frame_array.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements the CLOCK-Pro replacement policy, which approximates LIRS with a clock.
+ *
+ * Resident pages are hot or cold. A page starts cold, in its test period: if it is accessed again before the cold
+ * hand comes back to it, it turns hot. A cold page evicted in its test period stays in the clock as a non-resident
+ * entry, and is admitted hot if it is missed before the test period ends. Three hands go around the same clock:
+ * - the cold hand evicts the cold pages whose reference bit is clear and promotes the others,
+ * - the hot hand demotes the hot pages whose reference bit is clear while there are more hot pages than their share,
+ * - the test hand ends the test period of the non-resident pages while there are more of them than the pool size.
+ *
+ * The share of cold pages adapts: a miss on a page in its test period means cold pages need more room, a test period
+ * that ends without an access means they need less. Like CLOCK, a hit only sets the reference bit of its frame.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * @param num_frames the initial number of frames, see SetPoolSize()
+   */
+  explicit ClockProReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ClockProReplacer);
+
+  ~ClockProReplacer() override = default;
+
+  void SetPoolSize(size_t pool_size) override;
+
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
+
+  /** An evicted cold page stays in the clock for the rest of its test period. */
+  void Remove(frame_id_t frame_id, bool evicted) override;
+
+  /** Visit the cold pages from the cold hand on, then the hot pages. */
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
+
+  /** @return the target number of resident cold pages */
+  auto GetColdTarget() const -> size_t { return cold_target_; }
+
+ private:
+  /** An entry of the clock: a resident hot or cold page, or a non-resident cold page in its test period. */
+  struct Entry {
+    page_id_t page_id_;
+    /** The frame holding the page, -1 if it is not resident. */
+    frame_id_t frame_id_;
+    bool hot_;
+  };
+  using Position = std::list<Entry>::iterator;
+
+  struct Frame {
+    /** The reference bit, set by buffer hits without the pool latch. */
+    std::atomic<bool> ref_{false};
+    /** The entry of the frame in clock_. */
+    Position position_;
+  };
+
+  /** Move the hot hand by one entry. */
+  void RunHandHot();
+
+  /** Move the test hand by one entry. */
+  void RunHandTest();
+
+  /** @return the entry a hand is on, after wrapping it around */
+  auto HandEntry(Position *hand) -> Position;
+
+  /** Remove an entry from the clock, moving the hands that are on it to the next one. */
+  void Erase(Position position);
+
+  size_t c_{0};
+  /** The target number of resident cold pages. */
+  size_t cold_target_{1};
+  size_t num_hot_{0};
+  size_t num_cold_{0};
+  size_t num_test_{0};
+  FrameArray<Frame> frames_;
+  std::list<Entry> clock_;
+  /** The non-resident entries by page id. */
+  std::unordered_map<page_id_t, Position> tests_;
+  /** The hands, end() stands for begin(). New entries go in right behind the hot hand. */
+  Position hand_cold_{clock_.end()};
+  Position hand_hot_{clock_.end()};
+  Position hand_test_{clock_.end()};
+};
+
+}  // namespace bustub
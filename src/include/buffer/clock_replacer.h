@@ -12,41 +12,59 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
-#include <mutex>  // NOLINT
-#include <vector>
 
+#include "buffer/frame_array.h"
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The tracked frames form a ring, new ones going in right behind the hand. A hit only sets the reference bit of its
+ * frame. The hand clears the bits it passes and stops at the first unpinned frame whose bit was already clear.
  */
 class ClockReplacer : public Replacer {
  public:
   /**
    * Create a new ClockReplacer.
-   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   * @param num_frames the initial number of frames, see SetPoolSize()
    */
-  explicit ClockReplacer(size_t num_pages);
+  explicit ClockReplacer(size_t num_frames);
 
-  /**
-   * Destroys the ClockReplacer.
-   */
-  ~ClockReplacer() override;
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
+  ~ClockReplacer() override = default;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void SetPoolSize(size_t pool_size) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  auto Size() -> size_t override;
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
+
+  void Remove(frame_id_t frame_id, bool evicted) override;
+
+  /** Visit the ring from the hand on. */
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
 
  private:
-  // TODO(student): implement me!
+  struct Frame {
+    /** The reference bit, set by buffer hits without the pool latch. */
+    std::atomic<bool> ref_{false};
+    /** The position of the frame in ring_. */
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  FrameArray<Frame> frames_;
+  std::list<frame_id_t> ring_;
+  /** The clock hand, end() stands for begin(). */
+  std::list<frame_id_t>::iterator hand_{ring_.end()};
 };
 
 }  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_array.h
+//
+// Identification: src/include/buffer/frame_array.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArray holds one T per frame of a buffer pool. It grows with the pool in chunks that never move, so that a
+ * buffer hit can get at the element of its frame without any latch while another thread grows the array.
+ */
+template <class T>
+class FrameArray {
+ public:
+  FrameArray() : chunks_(std::make_unique<std::atomic<T *>[]>(NUM_CHUNKS)) {
+    for (size_t i = 0; i < NUM_CHUNKS; i++) {
+      chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(FrameArray);
+
+  ~FrameArray() {
+    for (size_t i = 0; i < NUM_CHUNKS; i++) {
+      delete[] chunks_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Make room for the frames below num_frames. Calls must be serialized, but may run concurrently with lookups of the
+   * frames that are already there.
+   */
+  void Grow(size_t num_frames) {
+    BUSTUB_ASSERT(num_frames <= NUM_CHUNKS * CHUNK_SIZE, "too many frames");
+    for (size_t chunk = size_ / CHUNK_SIZE; chunk * CHUNK_SIZE < num_frames; chunk++) {
+      if (chunks_[chunk].load(std::memory_order_relaxed) == nullptr) {
+        chunks_[chunk].store(new T[CHUNK_SIZE](), std::memory_order_release);
+      }
+    }
+    if (num_frames > size_) {
+      size_ = num_frames;
+    }
+  }
+
+  /** @return the element of a frame below the size the array was grown to */
+  auto operator[](frame_id_t frame_id) const -> T & {
+    return chunks_[frame_id / CHUNK_SIZE].load(std::memory_order_acquire)[frame_id % CHUNK_SIZE];
+  }
+
+  /** @return the number of frames the array was grown to */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  static constexpr size_t CHUNK_SIZE = 256;
+  static constexpr size_t NUM_CHUNKS = (BUFFER_POOL_MAX_FRAMES + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  std::unique_ptr<std::atomic<T *>[]> chunks_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -12,13 +12,14 @@
 
 #pragma once
 
-#include <limits>
-#include <list>
-#include <memory>
+#include <array>
+#include <atomic>
 #include <mutex>  // NOLINT
-#include <unordered_map>
-#include <vector>
+#include <set>
+#include <utility>
 
+#include "buffer/frame_array.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -35,143 +36,73 @@ namespace bustub {
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
-   * @brief a new LRUKReplacer.
-   * @param num_frames the maximum number of frames the LRUReplacer will be required to store
+   * @param num_frames the initial number of frames, see SetPoolSize()
+   * @param k the lookback constant, at most LRUK_REPLACER_MAX_K
    */
-  explicit LRUKReplacer(size_t num_frames, size_t k);
+  LRUKReplacer(size_t num_frames, size_t k);
 
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
-  /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Destroys the LRUReplacer.
-   */
-  ~LRUKReplacer() = default;
-
-  /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
-   * that are marked as 'evictable' are candidates for eviction.
-   *
-   * A frame with less than k historical references is given +inf as its backward k-distance.
-   * If multiple frames have inf backward k-distance, then evict the frame with the earliest
-   * timestamp overall.
-   *
-   * Successful eviction of a frame should decrement the size of replacer and remove the frame's
-   * access history.
-   *
-   * @param[out] frame_id id of frame that is evicted.
-   * @return true if a frame is evicted successfully, false if no frames can be evicted.
-   */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  ~LRUKReplacer() override = default;
 
-  /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Record the event that the given frame id is accessed at current timestamp.
-   * Create a new entry for access history if frame id has not been seen before.
-   *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
-   *
-   * @param frame_id id of frame that received a new access.
-   */
-  void RecordAccess(frame_id_t frame_id);
+  void SetPoolSize(size_t pool_size) override;
 
-  /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Toggle whether a frame is evictable or non-evictable. This function also
-   * controls replacer's size. Note that size is equal to number of evictable entries.
-   *
-   * If a frame was previously evictable and is to be set to non-evictable, then size should
-   * decrement. If a frame was previously non-evictable and is to be set to evictable,
-   * then size should increment.
-   *
-   * If frame id is invalid, throw an exception or abort the process.
-   *
-   * For other scenarios, this function should terminate without modifying anything.
-   *
-   * @param frame_id id of frame whose 'evictable' status will be modified
-   * @param set_evictable whether the given frame is evictable or not
-   */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
 
-  /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Remove an evictable frame from replacer, along with its access history.
-   * This function should also decrement replacer's size if removal is successful.
-   *
-   * Note that this is different from evicting a frame, which always remove the frame
-   * with largest backward k-distance. This function removes specified frame id,
-   * no matter what its backward k-distance is.
-   *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
-   *
-   * If specified frame is not found, directly return from this function.
-   *
-   * @param frame_id id of frame to be removed
-   */
-  auto Remove(frame_id_t frame_id) -> bool;
+  /** Record the access at the current timestamp, under the latch of the frame only. */
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
-   * @brief Return replacer's size, which tracks the number of evictable frames.
-   *
-   * @return size_t
+   * Frames with +inf backward k-distance go first, the one with the earliest access winning, then the one with the
+   * largest backward k-distance.
    */
-  auto Size() -> size_t;
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
 
- private:
-  class Frame {
-   public:
-    Frame(size_t k) : k_(k) {}
+  void Remove(frame_id_t frame_id, bool evicted) override;
 
-    void RecordAccess(size_t timestamp) {
-      access_histories_.push_back(timestamp);
-      if (access_histories_.size() > k_) access_histories_.pop_front();
-    }
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
 
-    void SetEvictable(bool evictable) { evictable_ = evictable; }
+ private:
+  struct Frame {
+    /**
+     * Timestamps of the last k accesses, a ring buffer of k slots that starts at history_begin_ once it is full. It
+     * lives in the frame, so recording an access never allocates.
+     */
+    std::array<size_t, LRUK_REPLACER_MAX_K> history_;
+    uint32_t history_begin_{0};
+    uint32_t history_size_{0};
+    /** Protects the history, which buffer hits update without the pool latch. */
+    std::mutex latch_;
+    /** The key the frame is filed under in the eviction index: (has k accesses, earliest access). */
+    std::pair<bool, size_t> index_key_{false, 0};
+  };
 
-    auto Evictable() -> bool { return evictable_; }
+  /** @return the key of the frame in the LRU-k eviction order: (has k accesses, earliest access) */
+  auto EvictionKey(Frame &frame) -> std::pair<bool, size_t>;
 
-    auto AccessHistories() -> std::list<size_t> { return access_histories_; }
+  /** File the frame in the eviction index under its current key. */
+  void IndexFrame(frame_id_t frame_id);
 
-    auto KDistance(size_t current_timestamp) -> size_t {
-      if (access_histories_.size() < k_) return INT64_MAX;
-      return current_timestamp - access_histories_.front();
-    }
+  /** Drop the frame from the eviction index. */
+  void UnindexFrame(frame_id_t frame_id);
 
-    auto Distance(size_t current_timestamp) -> size_t {
-      if (access_histories_.empty()) return INT64_MAX;
-      return current_timestamp - access_histories_.front();
-    }
+  const size_t k_;
+  std::atomic<size_t> current_timestamp_{0};
+  FrameArray<Frame> frames_;
 
-    
-    std::list<size_t> access_histories_{};
-    size_t k_;
-    bool evictable_{};
-  };
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  size_t current_timestamp_{0};
-  size_t evictable_size_{0};
-  size_t replacer_size_;
-  size_t k_;
-  std::mutex mutex_;
-  std::vector<std::shared_ptr<Frame> > frames_;
+  /**
+   * The eviction index. Every tracked frame is in one of the sets, keyed by (earliest timestamp in its access history,
+   * frame_id): the frames with fewer than k accesses in history_set_, the others in cache_set_. For the latter the
+   * earliest timestamp is the k-th previous access, so the smallest key is the largest backward k-distance.
+   *
+   * Buffer hits record their access without the pool latch, so the key a frame is filed under may be out of date. It
+   * can only be too small, and Victim() refiles the frames it comes across.
+   */
+  std::set<std::pair<size_t, frame_id_t>> history_set_;
+  std::set<std::pair<size_t, frame_id_t>> cache_set_;
 };
 
-}  // namespace bustub
\ No newline at end of file
+}  // namespace bustub
@@ -12,12 +12,14 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
+#include <atomic>
+#include <set>
+#include <utility>
 
+#include "buffer/frame_array.h"
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
@@ -28,25 +30,42 @@ class LRUReplacer : public Replacer {
  public:
   /**
    * Create a new LRUReplacer.
-   * @param num_pages the maximum number of pages the LRUReplacer will be required to store
+   * @param num_frames the initial number of frames, see SetPoolSize()
    */
-  explicit LRUReplacer(size_t num_pages);
+  explicit LRUReplacer(size_t num_frames);
 
-  /**
-   * Destroys the LRUReplacer.
-   */
-  ~LRUReplacer() override;
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
+
+  ~LRUReplacer() override = default;
+
+  void SetPoolSize(size_t pool_size) override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
 
-  void Pin(frame_id_t frame_id) override;
+  /** Stamp the frame with the current timestamp, a single atomic store. */
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
 
-  auto Size() -> size_t override;
+  void Remove(frame_id_t frame_id, bool evicted) override;
+
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
 
  private:
-  // TODO(student): implement me!
+  struct Frame {
+    /** Timestamp of the last access, stamped by buffer hits without the pool latch. */
+    std::atomic<size_t> last_access_{0};
+    /** The timestamp the frame is filed under in lru_set_. */
+    size_t index_key_{0};
+  };
+
+  std::atomic<size_t> current_timestamp_{0};
+  FrameArray<Frame> frames_;
+  /**
+   * Tracked frames keyed by (last access, frame_id), least recently used first. Like the LRU-K index, keys may be out
+   * of date and are refiled by Victim().
+   */
+  std::set<std::pair<size_t, frame_id_t>> lru_set_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames that hold them.
+ *
+ * It is an open addressing hash table with linear probing, sized to at least twice the number of frames so that probe
+ * sequences stay short. Every slot is a single atomic word holding a (page id, frame id) pair, so Find() takes no
+ * latch at all: a lookup racing with an update sees the slot either before or after it. Insert(), Remove() and Grow()
+ * must be serialized by the caller, the buffer pool manager does them under its pool latch.
+ *
+ * Removed entries leave a tombstone behind, so that lookups keep probing past them. A run of tombstones is turned back
+ * into empty slots as soon as it is followed by an empty slot, since no probe sequence can go through it anymore.
+ *
+ * Grow() rehashes into a bigger table and switches lookups over to it. A lookup that started on the old table finishes
+ * there and may miss the updates made since, or find entries removed since: the buffer pool manager checks the frame
+ * it gets against the page anyway, and retries a miss under its latch. Old tables are kept until the page table is
+ * destroyed, since lookups may still be probing them. Capacities double, so they take no more room than the current
+ * one.
+ */
+class PageTable {
+ public:
+  /**
+   * @param num_frames the number of frames of the buffer pool, i.e. the max number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * Look up a page. Safe to call concurrently with Insert() and Remove().
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page is in the table
+   */
+  auto Find(page_id_t page_id, frame_id_t &frame_id) const -> bool;
+
+  /**
+   * Map a page to a frame, replacing the frame it was mapped to if any.
+   * @param page_id the page, cannot be INVALID_PAGE_ID
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Unmap a page.
+   * @param page_id the page to unmap
+   * @return true if the page was in the table
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /**
+   * Make room for the entries of num_frames frames, rehashing into a bigger table if needed.
+   * @param num_frames the new number of frames of the buffer pool
+   */
+  void Grow(size_t num_frames);
+
+  /** @return the number of slots of the table */
+  auto GetCapacity() const -> size_t { return table_.load()->mask_ + 1; }
+
+ private:
+  /** Page id of a slot that was never used, or that no probe sequence goes through anymore. */
+  static constexpr page_id_t EMPTY = INVALID_PAGE_ID;
+  /** Page id of a slot whose entry was removed, lookups must probe past it. */
+  static constexpr page_id_t TOMBSTONE = -2;
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32 | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** The slots of one generation of the table. */
+  struct Table {
+    explicit Table(size_t num_frames);
+
+    /** @return the slot the probe sequence of page_id starts at */
+    auto HomeSlot(page_id_t page_id) const -> size_t;
+
+    /** Slot index mask, the capacity is a power of two. */
+    size_t mask_;
+    /** Number of bits of a slot index, used to take the high bits of the hash. */
+    size_t bits_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  };
+
+  /** Insert() into the given table. */
+  static void InsertInto(Table *table, page_id_t page_id, frame_id_t frame_id);
+
+  /** The current table, the one updates go to. */
+  std::atomic<Table *> table_;
+  /** Every table ever used, the current one last. */
+  std::vector<std::unique_ptr<Table>> tables_;
+};
+
+}  // namespace bustub
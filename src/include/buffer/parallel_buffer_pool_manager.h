@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards pages over several independent BufferPoolManagerInstances, so that threads working
+ * on different pages do not serialize on a single pool latch. A page lives in instance (page_id % num_instances), and
+ * every instance allocates the page ids that map back to itself.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override = default;
+
+  /** @return size of the buffer pool, i.e. the total number of frames over all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return the counters of every instance, added up */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * Resize every instance, spreading new_size frames evenly over them.
+   * @return false if there are fewer frames than instances, or too many
+   */
+  auto Resize(size_t new_size) -> bool override;
+
+  /** @return the number of instances the pages are sharded over */
+  auto GetNumInstances() -> size_t { return instances_.size(); }
+
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /** Start a page cleaner in every instance, see BufferPoolManagerInstance::StartPageCleaner(). */
+  void StartPageCleaner(size_t batch_size = PAGE_CLEANER_BATCH_SIZE, double dirty_ratio = PAGE_CLEANER_DIRTY_RATIO);
+
+  /** Stop the page cleaner of every instance. */
+  void StopPageCleaner();
+
+  /** Hand each page to the prefetcher of the instance responsible for it. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /** Split the pages by instance and fetch each share with one FetchPages() call to its instance. */
+  auto FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) -> bool override;
+
+  /** Dump every instance to its own file, dump_file suffixed with the instance index. */
+  auto DumpPool(const std::string &dump_file) -> bool override;
+
+  /** Warm every instance up from the file DumpPool() wrote for it. */
+  auto WarmUp(const std::string &dump_file) -> size_t override;
+
+  // ==================== for test ================
+
+  void Print() override;
+
+  /** Frames are not contiguous across instances, use GetBufferPoolManager(page_id)->GetFrames() instead. */
+  auto GetFrames() -> Page * override { return nullptr; }
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool. A strategy keeps a single ring over all the instances, and each
+   * instance only recycles the ring frames it owns.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of a bulk read, nullptr for a regular fetch
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried round robin, starting from a different one on every
+   * call, so that new pages are spread evenly and one full instance does not fail the request.
+   * @param[out] page_id id of created page
+   * @param segment the segment to allocate the page in, INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, page_id_t segment) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the dirty pages in the buffer pool to disk, with a single sync for all the instances.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The disk manager shared by the instances. */
+  DiskManager *disk_manager_;
+  /** The shards, instance i owns the pages with page_id % num_instances == i. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance NewPgImp starts from next. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ReadAhead keeps the upcoming pages of a sequential scan over a linked list of pages (table heap pages, B+ tree
+ * leaves) in flight through BufferPoolManager::PrefetchPages().
+ *
+ * The id of a page is only known once the page before it is read, so the window grows by one page per page scanned:
+ * the next pointer is read from the last page asked for, which was prefetched one page earlier.
+ */
+class ReadAhead {
+ public:
+  /** Reads the id of the next page out of a page of the list. */
+  using NextPageFn = page_id_t (*)(Page *page);
+
+  ReadAhead() = default;
+
+  /**
+   * @param bpm the buffer pool manager the scan fetches its pages from
+   * @param next_page reads the id of the next page out of a page
+   * @param window max number of pages kept in flight, 0 disables read-ahead
+   */
+  ReadAhead(BufferPoolManager *bpm, NextPageFn next_page, size_t window = read_ahead_window)
+      : bpm_(bpm), next_page_(next_page), window_(window) {}
+
+  /**
+   * Called when the scan moves on to a page.
+   * @param next_page_id the id of the page after the one the scan is on now
+   */
+  void Advance(page_id_t next_page_id);
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  NextPageFn next_page_{nullptr};
+  size_t window_{0};
+  /** Ids of the upcoming pages that were asked for, in scan order. */
+  std::deque<page_id_t> pages_;
+};
+
+}  // namespace bustub
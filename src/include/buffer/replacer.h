@@ -12,12 +12,24 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+
 #include "common/config.h"
 
 namespace bustub {
 
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is the replacement policy of a buffer pool: it tracks the frames that hold a page and picks the one to
+ * evict.
+ *
+ * The buffer pool manager calls every method but RecordAccess() under its pool latch, so those never run concurrently.
+ * RecordAccess() is called by buffer hits, which take no latch, and may run at any time. It is only called on a
+ * tracked frame that stays tracked during the call, since the hit holds a pin. Implementations keep it cheap, usually
+ * by updating per-frame state that Victim() folds into the replacement order later.
+ *
+ * Pins are not tracked here, Victim() is told which frames can be evicted.
  */
 class Replacer {
  public:
@@ -25,26 +37,57 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * The buffer pool now has pool_size frames. Frame ids stay below the largest pool size ever set. When the pool
+   * shrinks, the frames above the new size are removed as the buffer pool drains them.
+   */
+  virtual void SetPoolSize(size_t pool_size) = 0;
+
+  /**
+   * Start tracking a frame that was just mapped to a page, by a miss or a new page. This counts as its first access.
+   * @param frame_id the frame
+   * @param page_id the page it holds, policies that remember evicted pages look it up in their history
+   */
+  virtual void Admit(frame_id_t frame_id, page_id_t page_id) = 0;
+
+  /**
+   * Record a buffer hit on a tracked frame.
+   * @param frame_id the frame that was accessed
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Pick the frame to evict. The frame stays tracked: the buffer pool calls Remove() once it has evicted the page, or
+   * asks again if it could not.
+   * @param evictable tells whether a frame can be evicted, i.e. is not pinned
+   * @return the id of the victim, -1 if no tracked frame can be evicted
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Stop tracking a frame.
+   * @param frame_id the frame
+   * @param evicted true if its page was evicted, false if it was deleted. Only evicted pages are remembered.
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id, bool evicted) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
-  virtual auto Size() -> size_t = 0;
+  /**
+   * Visit the tracked frames, roughly in the order they would be evicted, until `visit` returns false. The order is
+   * left as it is.
+   */
+  virtual void ForEach(const std::function<bool(frame_id_t)> &visit) = 0;
 };
 
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerType { LRU_K, LRU, CLOCK, ARC, TWO_QUEUE, CLOCK_PRO };
+
+/**
+ * @param type the replacement policy
+ * @param replacer_k the lookback constant k, for LRU_K only
+ * @return a new replacer for an empty buffer pool
+ */
+auto CreateReplacer(ReplacerType type, size_t replacer_k = LRUK_REPLACER_K) -> std::unique_ptr<Replacer>;
+
+/** @return the name of a replacement policy, e.g. "LRU-K" */
+auto ReplacerTypeToString(ReplacerType type) -> std::string;
+
 }  // namespace bustub
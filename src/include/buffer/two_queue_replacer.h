@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/frame_array.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q replacement policy.
+ *
+ * A page seen for the first time goes into A1in, a FIFO queue of a quarter of the pool, where hits do not move it: a
+ * burst of accesses right after a page is read in says nothing about whether it is hot. Pages evicted from A1in are
+ * remembered in A1out, a ghost FIFO of page ids half as long as the pool. Only a page missed again while in A1out is
+ * considered hot and goes into Am, an LRU list. A scan thus churns through A1in and A1out, and leaves Am alone.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @param num_frames the initial number of frames, see SetPoolSize()
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  /** Sizes A1in to a quarter of the pool and A1out to half of it. */
+  void SetPoolSize(size_t pool_size) override;
+
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
+
+  /** Stamp the frame with the current timestamp, a single atomic store. */
+  void RecordAccess(frame_id_t frame_id) override;
+
+  /** The head of A1in while A1in is over its size, the least recently used page of Am otherwise. */
+  auto Victim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t override;
+
+  /** A page evicted from A1in is remembered in A1out. */
+  void Remove(frame_id_t frame_id, bool evicted) override;
+
+  /** Visit A1in, then Am. */
+  void ForEach(const std::function<bool(frame_id_t)> &visit) override;
+
+ private:
+  struct Frame {
+    /** Timestamp of the last access, stamped by buffer hits without the pool latch. */
+    std::atomic<size_t> last_access_{0};
+    /** The page held by the frame. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** True if the frame is in Am, false if it is in A1in. */
+    bool in_am_{false};
+    /** The timestamp the frame is filed under in am_, if it is in Am. */
+    size_t index_key_{0};
+    /** The position of the frame in a1in_, if it is in A1in. */
+    std::list<frame_id_t>::iterator position_;
+  };
+
+  /** @return the first evictable frame of A1in, -1 if none */
+  auto A1inVictim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t;
+
+  /** @return the least recently used evictable frame of Am, -1 if none */
+  auto AmVictim(const std::function<bool(frame_id_t)> &evictable) -> frame_id_t;
+
+  size_t kin_{1};
+  size_t kout_{1};
+  std::atomic<size_t> current_timestamp_{0};
+  FrameArray<Frame> frames_;
+  std::list<frame_id_t> a1in_;
+  /** A1out, oldest page first, and the position of each of its pages. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  /** Am keyed by (last access, frame_id), refiled lazily like the LRU index. */
+  std::set<std::pair<size_t, frame_id_t>> am_;
+};
+
+}  // namespace bustub
@@ -270,8 +270,11 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayStats(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
+  /** Where the buffer pool is dumped on shutdown and warmed up from on startup, empty for an in-memory instance. */
+  std::string pool_dump_file_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -21,6 +22,12 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** The background page cleaner of the buffer pool wakes up every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** Sequential scans of table heaps and B+ tree leaves keep up to READ_AHEAD_WINDOW upcoming pages in flight. */
+extern std::atomic<size_t> read_ahead_window;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
@@ -36,6 +43,17 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_MAX_K = 16;               // max lookback window, sizes the inline histories
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 16;           // max pages written back per page cleaner round
+static constexpr double PAGE_CLEANER_DIRTY_RATIO = 0.1;      // fraction of the pool left dirty by the page cleaner
+static constexpr int BULK_READ_RING_SIZE = 16;               // frames recycled by a sequential scan
+static constexpr int WARM_UP_BATCH_SIZE = 32;                // max pages loaded by one disk read in a warm restore
+static constexpr int BUFFER_POOL_MAX_FRAMES = 1 << 20;       // max frames of a buffer pool instance after a resize
+static constexpr int INDEX_JOIN_BATCH_SIZE = 64;             // outer tuples probed together by a nested index join
+static constexpr int DISK_SCHEDULER_QUEUE_DEPTH = 64;        // disk requests in flight at once
+static constexpr int DISK_SCHEDULER_THREADS = 4;             // disk scheduler workers where io_uring is not used
+static constexpr int EXTENT_SIZE = 64;                       // consecutive pages a segment is allocated at a time
+static constexpr int NEW_SEGMENT = -2;                       // NewPage() segment that starts a new table or index
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -16,6 +16,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -51,6 +52,9 @@ class ExecutorContext {
   /** @return the buffer pool manager */
   auto GetBufferPoolManager() -> BufferPoolManager * { return bpm_; }
 
+  /** @return the access strategy sequential scans of this query fetch their pages with */
+  auto GetScanStrategy() -> BufferAccessStrategy * { return &scan_strategy_; }
+
   /** @return the log manager - don't worry about it for now */
   auto GetLogManager() -> LogManager * { return nullptr; }
 
@@ -71,6 +75,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The ring of frames the sequential scans of this query recycle, so that they do not wash out the buffer pool */
+  BufferAccessStrategy scan_strategy_;
 };
 
 }  // namespace bustub
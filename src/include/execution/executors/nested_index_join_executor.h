@@ -54,5 +54,17 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   IndexInfo * index_info_;
   TableInfo * index_table_info_;
   BPlusTreeIndexForOneIntegerColumn * index_;
+
+  /**
+   * Pull up to INDEX_JOIN_BATCH_SIZE outer tuples and probe the index for all of them at once.
+   * @return false if the outer table is exhausted
+   */
+  auto NextBatch() -> bool;
+
+  /** The outer tuples of the current batch, and the RIDs each one matched in the index. */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<std::vector<RID>> matches_;
+  /** The next outer tuple of the batch to join. */
+  size_t batch_cursor_{0};
 };
 }  // namespace bustub
@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <sys/uio.h>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,19 +29,29 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread() and pwrite() on the database file, without any latch: reads and writes of
+ * different pages run in parallel. Concurrent writes of the same page are the buffer pool's business, it never issues
+ * them.
+ *
+ * With direct I/O, the database file is opened with O_DIRECT: pages are cached by the buffer pool only, not a second
+ * time by the OS page cache. The buffers handed to O_DIRECT reads and writes must be aligned, the frames of the buffer
+ * pool are, other buffers are bounced through an aligned copy.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache. Falls back to buffered I/O
+   * where the file system does not support it.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -58,6 +72,66 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read consecutive pages from the database file with a single read. Pages past the end of the file read as zeros.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to read
+   * @param[out] page_data output buffer of num_pages pages
+   */
+  virtual void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data);
+
+  /**
+   * Write consecutive pages to the database file straight from their frames, with one vectored write per run of
+   * pages that are next to each other in the file. Like WritePage(), this does not sync the file.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to write
+   * @param page_data raw data of each page
+   */
+  virtual void WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data);
+
+  /** Make the pages written so far durable, with a single fdatasync() of the database file. */
+  virtual void SyncPages();
+
+  /**
+   * Where a page is in the database file, for the DiskScheduler to read and write it without ReadPage() and
+   * WritePage(). Disk managers that do their own I/O must return -1.
+   * @param page_id id of the page
+   * @param[out] offset offset of the page in the file
+   * @return the file descriptor of the database file, -1 if the page must go through ReadPage() and WritePage()
+   */
+  virtual auto GetPageFile(page_id_t page_id, size_t *offset) -> int;
+
+  /**
+   * Account for a write of a page done directly on the file returned by GetPageFile().
+   * @param page_id id of the page
+   */
+  void PageWritten(page_id_t page_id);
+
+  /**
+   * Allocate a page: the lowest free page id of the stripe, so that the pages freed by DeallocatePage() are reused
+   * before the database grows. The allocation is recorded in the space map of the database file before this returns,
+   * so the page is not handed out again after a restart, until it is deallocated.
+   *
+   * The pages of a table or index can be kept together in a segment: extents of EXTENT_SIZE consecutive pages that
+   * only that segment allocates from, so that a scan of it reads contiguous ranges of the file. A segment is named by
+   * any page of it, NEW_SEGMENT starts one in an extent of its own. Which extents belong to which segment is only
+   * known in memory. After a restart, the extent of the page naming a segment becomes the segment's first extent.
+   * @param stride the number of stripes, one per buffer pool instance
+   * @param offset the stripe to allocate from: the page id satisfies page_id % stride == offset
+   * @param segment a page of the segment to allocate in, NEW_SEGMENT, or INVALID_PAGE_ID for no segment
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(uint32_t stride = 1, uint32_t offset = 0, page_id_t segment = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * Free a page, its id may be handed out again by AllocatePage(). Freeing a page that is not allocated does nothing.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +157,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return true if the database file is read and written with O_DIRECT */
+  auto IsDirectIo() const -> bool;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,19 +170,80 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /**
+   * The database file is made of groups of SPACE_MAP_GROUP_SIZE pages, each one preceded by a space map page that
+   * holds a bit per page of the group, set if the page is allocated.
+   */
+  static constexpr size_t SPACE_MAP_GROUP_SIZE = BUSTUB_PAGE_SIZE * 8;
+
+  /** Alignment of the buffers, offsets and sizes of O_DIRECT reads and writes. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = BUSTUB_PAGE_SIZE;
+
+  /** @return the offset of a page in the database file, past the space map pages */
+  static auto PageOffset(page_id_t page_id) -> size_t;
+
+  /** Read size bytes at offset of the database file, past the end of the file reads as zeros. */
+  virtual void ReadAt(size_t offset, size_t size, char *data);
+
+  /** Write size bytes at offset of the database file, and grow the file size accordingly. */
+  void WriteAt(size_t offset, size_t size, const char *data);
+
+  /** Write the buffers of iov one after the other at offset of the database file, see WriteAt(). */
+  void WriteAt(size_t offset, iovec *iov, int iovcnt);
+
+  /** Grow db_file_size_ to cover the bytes up to end, if it does not already. */
+  void GrowFileSize(size_t end);
+
+  /** Load the space map from the database file. */
+  void ReadSpaceMap();
+
+  /** Write the space map page of the group of a page to the database file, if there is one. Needs space_map_latch_. */
+  void WriteSpaceMap(page_id_t page_id);
+
+  /** @return the lowest free page of the stripe outside of the segments. Needs space_map_latch_. */
+  auto FindFreePage(uint32_t stride, uint32_t offset) -> size_t;
+
+  /** @return a free page of the stripe in the segment, claiming a new extent if it has none. Needs space_map_latch_. */
+  auto FindFreePageInSegment(uint32_t stride, uint32_t offset, page_id_t segment) -> size_t;
+
+  /** @return the segment an extent belongs to, INVALID_PAGE_ID if none. Needs space_map_latch_. */
+  auto ExtentOwner(size_t extent) -> page_id_t;
+
+  /** @return true if no page of the extent is allocated. Needs space_map_latch_. */
+  auto IsExtentFree(size_t extent) -> bool;
+
+  /** @return true if the page is allocated. Needs space_map_latch_. */
+  auto IsAllocatedLocked(size_t page_id) -> bool;
+
   auto GetFileSize(const std::string &file_name) -> int;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, -1 if there is none
+  int db_fd_{-1};
+  // whether db_fd_ was opened with O_DIRECT
+  bool direct_io_{false};
   std::string file_name_;
+  /** Size of the db file, kept up to date by the writes so that reads need no stat(). */
+  std::atomic<size_t> db_file_size_{0};
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+  /**
+   * The allocation bits of every page, a whole number of groups. Disk managers without a database file keep it in
+   * memory only.
+   */
+  std::vector<uint64_t> space_map_;
+  /** The lowest page id of each stripe that may be free, by (stride, offset). */
+  std::map<std::pair<uint32_t, uint32_t>, page_id_t> allocation_hints_;
+  /** The segment of each extent, by extent number, INVALID_PAGE_ID for the extents of no segment. */
+  std::vector<page_id_t> extent_owners_;
+  /** The extents of each segment, in the order they were claimed. A segment is keyed by the page that started it. */
+  std::map<page_id_t, std::vector<size_t>> segment_extents_;
+  /** Protects the space map and the segments, and serializes the writes of the space map pages. */
+  std::mutex space_map_latch_;
 };
 
 }  // namespace bustub
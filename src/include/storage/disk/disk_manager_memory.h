@@ -52,6 +52,22 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /**
+   * Read consecutive pages from the database file.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to read
+   * @param[out] page_data output buffer of num_pages pages
+   */
+  void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) override;
+
+  /**
+   * Write consecutive pages to the database file.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to write
+   * @param page_data raw data of each page
+   */
+  void WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data) override;
+
  private:
   char *memory_;
 };
@@ -106,6 +122,30 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Read consecutive pages from the database file.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to read
+   * @param[out] page_data output buffer of num_pages pages
+   */
+  void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) override {
+    for (size_t i = 0; i < num_pages; i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), page_data + i * BUSTUB_PAGE_SIZE);
+    }
+  }
+
+  /**
+   * Write consecutive pages to the database file.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages to write
+   * @param page_data raw data of each page
+   */
+  void WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data) override {
+    for (size_t i = 0; i < num_pages; i++) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), page_data[i]);
+    }
+  }
+
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <shared_mutex>
+#include <string>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** How the pages of the database file are going to be read, see DiskManagerMmap::SetAccessPattern(). */
+enum class AccessPattern { RANDOM, SEQUENTIAL };
+
+/**
+ * DiskManagerMmap maps the database file into memory and serves reads as a memcpy from the mapping, instead of a
+ * pread() system call per page. It suits read-mostly tables whose file fits in the address space.
+ *
+ * Writes still go through pwrite(), like the DiskManager ones. The mapping is shared with the OS page cache, so it
+ * sees them right away, and a page never reaches the file before the buffer pool writes it back: the write-ahead
+ * logging rules hold as they do for DiskManager. The mapping reaches past the end of the file, and is replaced by a
+ * larger one when the file outgrows it.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that maps the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param access_pattern how the pages are going to be read
+   */
+  explicit DiskManagerMmap(const std::string &db_file, AccessPattern access_pattern = AccessPattern::RANDOM);
+
+  ~DiskManagerMmap() override;
+
+  /**
+   * Hint the kernel about the order of the reads to come: read-ahead for sequential scans, none for random lookups.
+   * @param access_pattern how the pages are going to be read
+   */
+  void SetAccessPattern(AccessPattern access_pattern);
+
+  /** Reads are memcpy calls, the DiskScheduler has to go through ReadPage() for them. */
+  auto GetPageFile(page_id_t page_id, size_t *offset) -> int override;
+
+ protected:
+  /** Copy size bytes at offset out of the mapping, remapping the file if it grew past it. */
+  void ReadAt(size_t offset, size_t size, char *data) override;
+
+ private:
+  /** Map at least the whole database file, replacing the current mapping. Needs mapping_latch_ exclusively. */
+  void Map();
+
+  /** Apply access_pattern_ to the mapping. Needs mapping_latch_. */
+  void Advise();
+
+  /** Taken shared by the reads of the mapping, exclusively to replace it. */
+  std::shared_mutex mapping_latch_;
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+  AccessPattern access_pattern_;
+};
+
+}  // namespace bustub
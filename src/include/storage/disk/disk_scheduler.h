@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskRequest is a read or a write of one page, run by the DiskScheduler.
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The page data: the buffer to read into, or the data to write. It must stay valid until the request completes. */
+  char *data_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** Set to true once the request has completed. */
+  std::promise<bool> callback_;
+};
+
+/**
+ * DiskScheduler runs page reads and writes on background workers, so that a thread can have many of them in flight
+ * and wait for them at once.
+ *
+ * On Linux, the requests for a database file go to an io_uring of queue_depth entries, which one worker thread fills
+ * and reaps. Where io_uring is not available, and for the disk managers without a file descriptor, a pool of worker
+ * threads calls ReadPage() and WritePage() of the disk manager.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * Start the workers.
+   * @param disk_manager the disk manager to read and write the pages of
+   * @param queue_depth the number of requests in flight at once
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t queue_depth = DISK_SCHEDULER_QUEUE_DEPTH);
+
+  /** Run the requests already scheduled to completion, then stop the workers. */
+  ~DiskScheduler();
+
+  DiskScheduler(const DiskScheduler &) = delete;
+  auto operator=(const DiskScheduler &) -> DiskScheduler & = delete;
+
+  /**
+   * Queue a request. It runs in the background, its callback_ is set once it has completed.
+   * @param request the request
+   */
+  void Schedule(DiskRequest request);
+
+  /** @return a promise for the callback_ of a request */
+  auto CreatePromise() -> std::promise<bool> { return {}; }
+
+  /** @return true if the requests go through io_uring, false if through the worker threads */
+  auto UsesIoUring() const -> bool { return ring_fd_ != -1; }
+
+ private:
+  /** Set up the io_uring, and leave ring_fd_ at -1 if it cannot be. */
+  void SetUpIoUring(size_t queue_depth);
+
+  /** Worker of the io_uring: submit the queued requests, up to the queue depth, and complete them as they finish. */
+  void RunIoUring();
+
+  /** Worker of the thread pool: run the queued requests one at a time through the disk manager. */
+  void RunThreadPool();
+
+  /** Run a request through the disk manager and complete it. */
+  void RunSync(DiskRequest *request);
+
+  DiskManager *disk_manager_;
+
+  /** Requests waiting for a worker, protected by mutex_. */
+  std::deque<DiskRequest> queue_;
+  bool stopping_{false};
+  std::mutex mutex_;
+  /** Wakes up the workers, waited on with mutex_. */
+  std::condition_variable cv_;
+  std::vector<std::thread> workers_;
+
+  /** The io_uring file descriptor, -1 without io_uring. */
+  int ring_fd_{-1};
+  /** The io_uring mappings, and their sizes for munmap(). */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** The fields of the submission and completion queues, inside the mappings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Number of entries of the submission queue, the most requests in flight. */
+  unsigned ring_entries_{0};
+  /** Requests in flight in the io_uring, by slot. The slot is the user data of the submission. */
+  std::vector<DiskRequest> in_flight_;
+  std::vector<size_t> free_slots_;
+};
+
+}  // namespace bustub
@@ -13,7 +13,9 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "buffer/read_ahead.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -28,27 +30,41 @@ class IndexIterator {
   // using pointer           = MappingType*;
   // using reference         = MappingType&;
   // you may define your own constructor based on your member variables
-  IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page = nullptr, BufferPoolManager *bpm=nullptr, int index = 0);
-  ~IndexIterator();  // NOLINT
+  IndexIterator() = default;
+  /**
+   * @param bpm the buffer pool manager the leaf was fetched from
+   * @param guard the pin of the leaf the iterator starts on, which the iterator takes over
+   * @param index the position in the leaf the iterator starts at
+   */
+  IndexIterator(BufferPoolManager *bpm, BasicPageGuard guard, int index = 0);
+  ~IndexIterator() = default;  // NOLINT
+
+  /** The iterator owns the pin of its leaf, so it can be moved but not copied. */
+  IndexIterator(const IndexIterator &) = delete;
+  auto operator=(const IndexIterator &) -> IndexIterator & = delete;
+  IndexIterator(IndexIterator &&) noexcept = default;
+  auto operator=(IndexIterator &&) noexcept -> IndexIterator & = default;
 
   auto IsEnd() -> bool;
 
-  auto operator*() ->  MappingType &;
-  auto operator->() ->  MappingType *;
+  auto operator*() -> const MappingType &;
+  auto operator->() -> const MappingType *;
   // Prefix increment
   auto operator++() -> IndexIterator &;
-  // Postfix increment
-  auto operator++(int) -> IndexIterator;
 
-  auto operator==(const IndexIterator &other) const -> bool ;
+  auto operator==(const IndexIterator &other) const -> bool;
 
   auto operator!=(const IndexIterator &itr) const -> bool { return !(itr == *this); }
 
  private:
   // add your own private member variables here
-  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_ = nullptr;
-  BufferPoolManager *bpm_;
-  int index_;
+  BufferPoolManager *bpm_{nullptr};
+  /** Holds the pin of the leaf the iterator is on. */
+  BasicPageGuard guard_;
+  const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_{nullptr};
+  int index_{0};
+  /** Keeps the next leaves in flight. */
+  ReadAhead read_ahead_;
 };
 
 }  // namespace bustub
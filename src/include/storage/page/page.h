@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <list>
+#include <mutex>  // NOLINT
+#include <utility>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -29,13 +32,11 @@ namespace bustub {
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
-  friend class LRUKReplacer;
- 
 
  public:
   enum class State{NORMAL=0, WAITTING_TO_DELETE, DELETED};
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The frame has no data until the buffer pool manager hands it a buffer. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -46,8 +47,11 @@ class Page {
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
-  /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  /** @return the pin count of this page, 0 for a frame that holds no page */
+  inline auto GetPinCount() -> int {
+    int pin_count = pin_count_;
+    return pin_count == FRAME_CLAIMED ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
@@ -61,6 +65,9 @@ class Page {
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch without blocking. @return true if the latch was acquired */
+  inline auto TryRLatch() -> bool { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
@@ -71,7 +78,7 @@ class Page {
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
   void Print()  {
-    std::cout << "page_id: " <<  page_id_ << ", pin_count: " << pin_count_ << std::endl;
+    std::cout << "page_id: " <<  page_id_ << ", pin_count: " << GetPinCount() << std::endl;
   }
 
  protected:
@@ -86,53 +93,61 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /**
+   * The actual data that is stored within a page, a BUSTUB_PAGE_SIZE buffer owned by the buffer pool manager. It lives
+   * apart from the rest of the frame so that shrinking the buffer pool can release it, while the frame itself stays
+   * valid for the buffer hits that may still look at it.
+   */
+  char *data_{nullptr};
+  /**
+   * The ID of this page, the pin count and the dirty flag. They are atomic because the buffer pool manager pins and
+   * unpins resident pages without its pool latch.
+   */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page, FRAME_CLAIMED while the buffer pool manager maps or unmaps the frame. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 
-// ================= lru_k_replacer ======================
 private:
-  std::list<size_t> access_histories_{};
-  size_t k_ = 1;
-  State state_ = State::NORMAL;
+  /** Pin count of a frame that nobody can pin: it holds no page, or is being mapped or unmapped. */
+  static constexpr int FRAME_CLAIMED = -1;
+
+  /**
+   * True once a regular fetch hit the page since it was read in. Fetches through an access strategy leave it alone,
+   * so that a bulk read only recycles the frames of its ring that nobody else uses.
+   */
+  std::atomic<bool> referenced_ = false;
+  std::atomic<State> state_ = State::NORMAL;
   std::shared_mutex frame_mutex_;
 
-public:
-  void RecordAccess(size_t timestamp) {
-    pin_count_++;
-    access_histories_.push_back(timestamp);
-    if (access_histories_.size() > k_) {
-      access_histories_.pop_front();
+  /**
+   * Pin the frame, unless it is claimed.
+   * @return false if the frame is claimed
+   */
+  auto TryPin() -> bool {
+    int pin_count = pin_count_;
+    while (pin_count != FRAME_CLAIMED) {
+      if (pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+        return true;
+      }
     }
+    return false;
   }
 
+  /**
+   * Claim the frame if its pin count is `pin_count`, so that nobody can pin it anymore.
+   * @return false if the pin count is different
+   */
+  auto Claim(int pin_count) -> bool { return pin_count_.compare_exchange_strong(pin_count, FRAME_CLAIMED); }
+
+public:
   //void SetEvictable(bool evictable) { evictable_ = evictable; }
 
   auto Evictable() -> bool { return pin_count_ <= 0; }
 
-  // auto AccessHistories() -> std::list<size_t> { return access_histories_; }
-
-  auto KDistance(size_t current_timestamp) -> size_t {
-    if (access_histories_.size() < k_) return INT64_MAX;
-    return current_timestamp - access_histories_.front();
-  }
-
-  auto Distance(size_t current_timestamp) -> size_t {
-    if (access_histories_.empty()) return INT64_MAX;
-    return current_timestamp - access_histories_.front();
-  }
-  
-  void ClearAccessHistory(){
-    access_histories_.clear();
-  }
-
   void SetDirty(bool dirty){
     is_dirty_ = dirty;
   }
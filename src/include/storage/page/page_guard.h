@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard owns one pin of a page and unpins it when it goes out of scope, or when Drop() is called. The page is
+ * unpinned dirty if it was ever accessed through GetDataMut() or AsMut(), or marked with SetDirty().
+ *
+ * Guards are move-only: moving a guard hands its pin over, so a page is always unpinned exactly once.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool manager the page was fetched from
+   * @param page a pinned page, or nullptr for an empty guard
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
+
+  /** Take over the pin of `that`, which is left empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Unpin the page this guard holds, if any, and take over the pin of `that`, which is left empty. */
+  auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard &;
+
+  /** Unpin the page now. The guard is left empty, dropping it again does nothing. */
+  void Drop();
+
+  /** Take the read latch of the page and hand the pin over to the returned guard. This guard is left empty. */
+  auto UpgradeRead() -> ReadPageGuard;
+
+  /** Take the write latch of the page and hand the pin over to the returned guard. This guard is left empty. */
+  auto UpgradeWrite() -> WritePageGuard;
+
+  ~BasicPageGuard();
+
+  /** @return true if the guard holds a page, false if it is empty or the fetch failed */
+  explicit operator bool() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  auto PageId() -> page_id_t { return page_->GetPageId(); }
+
+  /** @return the guarded page, for the page types that derive from Page. Call SetDirty() after modifying it. */
+  auto GetPage() -> Page * { return page_; }
+
+  /** Unpin the page dirty. */
+  void SetDirty() { is_dirty_ = true; }
+
+  /** @return the data of the guarded page, read only */
+  auto GetData() -> const char * { return page_->GetData(); }
+
+  /** @return the data of the guarded page cast to T, read only */
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the guarded page, which is now considered dirty */
+  auto GetDataMut() -> char * {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the data of the guarded page cast to T, which is now considered dirty */
+  template <class T>
+  auto AsMut() -> T * {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard owns one pin and the read latch of a page, and releases both when it goes out of scope.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool manager the page was fetched from
+   * @param page a pinned page whose read latch the caller already holds, or nullptr for an empty guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** Release the page this guard holds, if any, and take over the one of `that`. */
+  auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &;
+
+  /** Release the read latch, then unpin the page. The guard is left empty. */
+  void Drop();
+
+  ~ReadPageGuard();
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetPage() -> Page * { return guard_.GetPage(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard owns one pin and the write latch of a page, and releases both when it goes out of scope. The page is
+ * unpinned dirty if it was accessed through GetDataMut() or AsMut(), or marked with SetDirty().
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * @param bpm the buffer pool manager the page was fetched from
+   * @param page a pinned page whose write latch the caller already holds, or nullptr for an empty guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** Release the page this guard holds, if any, and take over the one of `that`. */
+  auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard &;
+
+  /** Release the write latch, then unpin the page. The guard is left empty. */
+  void Drop();
+
+  ~WritePageGuard();
+
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetPage() -> Page * { return guard_.GetPage(); }
+
+  void SetDirty() { guard_.SetDirty(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  auto GetDataMut() -> char * { return guard_.GetDataMut(); }
+
+  template <class T>
+  auto AsMut() -> T * {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
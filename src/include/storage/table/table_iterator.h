@@ -14,6 +14,8 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/read_ahead.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -30,10 +32,14 @@ class TableIterator {
 
  public:
   TableIterator() : tuple_(new Tuple(RID(INVALID_PAGE_ID, 0))){};
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_(other.read_ahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -55,6 +61,8 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_ = other.read_ahead_;
     return *this;
   }
 
@@ -62,6 +70,10 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The access strategy the pages of the scan are fetched with, nullptr for regular fetches. */
+  BufferAccessStrategy *strategy_{nullptr};
+  /** Keeps the next pages of the table heap in flight. */
+  ReadAhead read_ahead_;
 };
 
 }  // namespace bustub
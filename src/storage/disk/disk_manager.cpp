@@ -10,8 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -29,8 +36,9 @@ static char *buffer_used;
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input direct_io: open the database file with O_DIRECT
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -49,17 +57,25 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // open the db file, create it if it does not exist
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ != -1;
+    if (db_fd_ == -1 && errno == EINVAL) {
+      LOG_WARN("the file system does not support O_DIRECT, using buffered I/O");
     }
   }
+  if (db_fd_ == -1) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ == -1) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = static_cast<size_t>(stat_buf.st_size);
+  }
+  ReadSpaceMap();
   buffer_used = nullptr;
 }
 
@@ -67,59 +83,322 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ != -1) {
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ != -1) {
+    close(db_fd_);
+  }
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
-  }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WriteAt(PageOffset(page_id), BUSTUB_PAGE_SIZE, page_data);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  ReadAt(PageOffset(page_id), BUSTUB_PAGE_SIZE, page_data);
+}
+
+auto DiskManager::GetPageFile(page_id_t page_id, size_t *offset) -> int {
+  *offset = PageOffset(page_id);
+  return db_fd_;
+}
+
+void DiskManager::PageWritten(page_id_t page_id) {
+  num_writes_ += 1;
+  GrowFileSize(PageOffset(page_id) + BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * Read the contents of consecutive pages into the given memory area
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) {
+  // The pages are next to each other in the file, unless the space map page of the next group is in between.
+  while (num_pages > 0) {
+    size_t run = std::min(num_pages, SPACE_MAP_GROUP_SIZE - static_cast<size_t>(first_page_id) % SPACE_MAP_GROUP_SIZE);
+    ReadAt(PageOffset(first_page_id), run * BUSTUB_PAGE_SIZE, page_data);
+    first_page_id += static_cast<page_id_t>(run);
+    num_pages -= run;
+    page_data += run * BUSTUB_PAGE_SIZE;
+  }
+}
+
+/**
+ * Write consecutive pages from their frames into disk file
+ */
+void DiskManager::WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data) {
+  num_writes_ += static_cast<int>(num_pages);
+  std::vector<iovec> iov;
+  while (num_pages > 0) {
+    size_t run = std::min(num_pages, SPACE_MAP_GROUP_SIZE - static_cast<size_t>(first_page_id) % SPACE_MAP_GROUP_SIZE);
+    run = std::min<size_t>(run, IOV_MAX);
+    iov.resize(run);
+    bool aligned = true;
+    for (size_t i = 0; i < run; i++) {
+      iov[i].iov_base = const_cast<char *>(page_data[i]);  // NOLINT
+      iov[i].iov_len = BUSTUB_PAGE_SIZE;
+      aligned = aligned && reinterpret_cast<uintptr_t>(page_data[i]) % DIRECT_IO_ALIGNMENT == 0;
+    }
+    if (direct_io_ && !aligned) {
+      // Let WriteAt() bounce the unaligned ones.
+      for (size_t i = 0; i < run; i++) {
+        WriteAt(PageOffset(first_page_id + static_cast<page_id_t>(i)), BUSTUB_PAGE_SIZE, page_data[i]);
+      }
+    } else {
+      WriteAt(PageOffset(first_page_id), iov.data(), static_cast<int>(run));
+    }
+    first_page_id += static_cast<page_id_t>(run);
+    num_pages -= run;
+    page_data += run;
+  }
+}
+
+/**
+ * Flush the pages written so far to the device
+ */
+void DiskManager::SyncPages() {
+  if (db_fd_ != -1 && fdatasync(db_fd_) == -1) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+/**
+ * Allocate a free page of a stripe, in a segment or outside of all of them, and record it in the space map
+ */
+auto DiskManager::AllocatePage(uint32_t stride, uint32_t offset, page_id_t segment) -> page_id_t {
+  std::scoped_lock scoped_space_map_latch(space_map_latch_);
+  size_t page_id =
+      segment == INVALID_PAGE_ID ? FindFreePage(stride, offset) : FindFreePageInSegment(stride, offset, segment);
+  if (page_id / 64 >= space_map_.size()) {
+    space_map_.resize((page_id / SPACE_MAP_GROUP_SIZE + 1) * SPACE_MAP_GROUP_SIZE / 64);
+  }
+  space_map_[page_id / 64] |= 1UL << (page_id % 64);
+  // Persist the allocation before the page is used: a crash may leak the page, but never hand it out twice.
+  WriteSpaceMap(static_cast<page_id_t>(page_id));
+  return static_cast<page_id_t>(page_id);
+}
+
+/**
+ * Free a page in the space map
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_space_map_latch(space_map_latch_);
+  auto bit = static_cast<size_t>(page_id);
+  if (page_id < 0 || bit / 64 >= space_map_.size() || (space_map_[bit / 64] & (1UL << (bit % 64))) == 0) {
+    return;
+  }
+  space_map_[bit / 64] &= ~(1UL << (bit % 64));
+  for (auto &[stripe, hint] : allocation_hints_) {
+    if (bit % stripe.first == stripe.second && page_id < hint) {
+      hint = page_id;
+    }
+  }
+  WriteSpaceMap(page_id);
+}
+
+auto DiskManager::FindFreePage(uint32_t stride, uint32_t offset) -> size_t {
+  page_id_t &hint = allocation_hints_.try_emplace({stride, offset}, static_cast<page_id_t>(offset)).first->second;
+  auto page_id = static_cast<size_t>(hint);
+  while (IsAllocatedLocked(page_id) || ExtentOwner(page_id / EXTENT_SIZE) != INVALID_PAGE_ID) {
+    page_id += stride;
+  }
+  hint = static_cast<page_id_t>(page_id + stride);
+  return page_id;
+}
+
+auto DiskManager::FindFreePageInSegment(uint32_t stride, uint32_t offset, page_id_t segment) -> size_t {
+  if (segment != NEW_SEGMENT) {
+    auto extent = static_cast<size_t>(segment) / EXTENT_SIZE;
+    page_id_t owner = ExtentOwner(extent);
+    if (owner == INVALID_PAGE_ID) {
+      // A segment started before a restart, or by a page allocated outside of the segments.
+      owner = segment;
+      extent_owners_.resize(std::max(extent_owners_.size(), extent + 1), INVALID_PAGE_ID);
+      extent_owners_[extent] = owner;
+      segment_extents_[owner].push_back(extent);
+    }
+    for (size_t owned : segment_extents_[owner]) {
+      size_t first = owned * EXTENT_SIZE;
+      for (size_t page_id = first + (offset + stride - first % stride) % stride; page_id < first + EXTENT_SIZE;
+           page_id += stride) {
+        if (!IsAllocatedLocked(page_id)) {
+          return page_id;
+        }
+      }
+    }
+  }
+
+  // Claim the first extent nothing was allocated in yet.
+  size_t extent = 0;
+  while (ExtentOwner(extent) != INVALID_PAGE_ID || !IsExtentFree(extent)) {
+    extent++;
+  }
+  size_t first = extent * EXTENT_SIZE;
+  size_t page_id = first + (offset + stride - first % stride) % stride;
+  page_id_t owner = segment == NEW_SEGMENT ? static_cast<page_id_t>(page_id) : ExtentOwner(segment / EXTENT_SIZE);
+  extent_owners_.resize(std::max(extent_owners_.size(), extent + 1), INVALID_PAGE_ID);
+  extent_owners_[extent] = owner;
+  segment_extents_[owner].push_back(extent);
+  return page_id;
+}
+
+auto DiskManager::ExtentOwner(size_t extent) -> page_id_t {
+  return extent < extent_owners_.size() ? extent_owners_[extent] : INVALID_PAGE_ID;
+}
+
+auto DiskManager::IsExtentFree(size_t extent) -> bool {
+  static_assert(EXTENT_SIZE % 64 == 0 && SPACE_MAP_GROUP_SIZE % EXTENT_SIZE == 0,
+                "extents are whole words of the space map, and never straddle a space map page");
+  for (size_t word = extent * EXTENT_SIZE / 64; word < (extent + 1) * EXTENT_SIZE / 64; word++) {
+    if (word < space_map_.size() && space_map_[word] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto DiskManager::IsAllocatedLocked(size_t page_id) -> bool {
+  return page_id / 64 < space_map_.size() && (space_map_[page_id / 64] & (1UL << (page_id % 64))) != 0;
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_space_map_latch(space_map_latch_);
+  return page_id >= 0 && IsAllocatedLocked(static_cast<size_t>(page_id));
+}
+
+auto DiskManager::PageOffset(page_id_t page_id) -> size_t {
+  auto page = static_cast<size_t>(page_id);
+  return (page + page / SPACE_MAP_GROUP_SIZE + 1) * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManager::ReadAt(size_t offset, size_t size, char *data) {
+  if (direct_io_ && reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT != 0) {
+    auto *aligned = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, size));
+    ReadAt(offset, size, aligned);
+    memcpy(data, aligned, size);
+    std::free(aligned);
+    return;
+  }
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(data, 0, size);
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(db_fd_, data + read_count, size - read_count, static_cast<off_t>(offset + read_count));
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1) {
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    if (n == 0) {
+      break;
+    }
+    read_count += static_cast<size_t>(n);
+  }
+  // if file ends before reading all of it
+  if (read_count < size) {
+    memset(data + read_count, 0, size - read_count);
+  }
+}
+
+void DiskManager::WriteAt(size_t offset, size_t size, const char *data) {
+  if (direct_io_ && reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT != 0) {
+    auto *aligned = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, size));
+    memcpy(aligned, data, size);
+    WriteAt(offset, size, aligned);
+    std::free(aligned);
+    return;
+  }
+  size_t write_count = 0;
+  while (write_count < size) {
+    ssize_t n = pwrite(db_fd_, data + write_count, size - write_count, static_cast<off_t>(offset + write_count));
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    write_count += static_cast<size_t>(n);
+  }
+  GrowFileSize(offset + size);
+}
+
+void DiskManager::WriteAt(size_t offset, iovec *iov, int iovcnt) {
+  size_t end = offset;
+  for (int i = 0; i < iovcnt; i++) {
+    end += iov[i].iov_len;
+  }
+  while (iovcnt > 0) {
+    ssize_t n = pwritev(db_fd_, iov, iovcnt, static_cast<off_t>(offset));
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    offset += static_cast<size_t>(n);
+    // Skip what was written, a short write may stop in the middle of a buffer.
+    auto written = static_cast<size_t>(n);
+    while (iovcnt > 0 && written >= iov->iov_len) {
+      written -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+      iov->iov_len -= written;
     }
   }
+  GrowFileSize(end);
+}
+
+void DiskManager::GrowFileSize(size_t end) {
+  // The file only grows, keep the largest end written.
+  size_t file_size = db_file_size_;
+  while (file_size < end && !db_file_size_.compare_exchange_weak(file_size, end)) {
+  }
+}
+
+void DiskManager::ReadSpaceMap() {
+  const size_t file_size = db_file_size_;
+  if (file_size == 0) {
+    return;
+  }
+  const size_t group_bytes = (SPACE_MAP_GROUP_SIZE + 1) * BUSTUB_PAGE_SIZE;
+  const size_t num_groups = (static_cast<size_t>(file_size) + group_bytes - 1) / group_bytes;
+  space_map_.resize(num_groups * SPACE_MAP_GROUP_SIZE / 64);
+  for (size_t group = 0; group < num_groups; group++) {
+    ReadAt(group * group_bytes, BUSTUB_PAGE_SIZE,
+           reinterpret_cast<char *>(space_map_.data() + group * SPACE_MAP_GROUP_SIZE / 64));
+  }
+}
+
+void DiskManager::WriteSpaceMap(page_id_t page_id) {
+  if (db_fd_ == -1) {
+    return;
+  }
+  const size_t group = static_cast<size_t>(page_id) / SPACE_MAP_GROUP_SIZE;
+  WriteAt(group * (SPACE_MAP_GROUP_SIZE + 1) * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE,
+          reinterpret_cast<const char *>(space_map_.data() + group * SPACE_MAP_GROUP_SIZE / 64));
 }
 
 /**
@@ -193,6 +472,11 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
  */
 auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
 
+/**
+ * Returns true if the db file bypasses the OS page cache
+ */
+auto DiskManager::IsDirectIo() const -> bool { return direct_io_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
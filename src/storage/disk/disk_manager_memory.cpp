@@ -47,4 +47,21 @@ void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Read the contents of consecutive pages into the given memory area
+ */
+void DiskManagerMemory::ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) {
+  int64_t offset = static_cast<int64_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  memcpy(page_data, memory_ + offset, num_pages * BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * Write the contents of consecutive pages into disk file
+ */
+void DiskManagerMemory::WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data) {
+  for (size_t i = 0; i < num_pages; i++) {
+    WritePage(first_page_id + static_cast<page_id_t>(i), page_data[i]);
+  }
+}
+
 }  // namespace bustub
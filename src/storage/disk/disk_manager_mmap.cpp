@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+
+#include "common/logger.h"
+
+namespace bustub {
+
+/**
+ * Constructor: open/create the database file and map it
+ */
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file, AccessPattern access_pattern)
+    : DiskManager(db_file), access_pattern_(access_pattern) {
+  std::scoped_lock lock(mapping_latch_);
+  Map();
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+void DiskManagerMmap::SetAccessPattern(AccessPattern access_pattern) {
+  std::scoped_lock lock(mapping_latch_);
+  access_pattern_ = access_pattern;
+  Advise();
+}
+
+auto DiskManagerMmap::GetPageFile(page_id_t /*page_id*/, size_t * /*offset*/) -> int { return -1; }
+
+void DiskManagerMmap::ReadAt(size_t offset, size_t size, char *data) {
+  {
+    // The mapping may reach past the end of the file, only the bytes the file has can be copied out of it.
+    std::shared_lock lock(mapping_latch_);
+    if (offset + size <= std::min<size_t>(mapping_size_, db_file_size_)) {
+      memcpy(data, mapping_ + offset, size);
+      return;
+    }
+  }
+  if (offset + size <= db_file_size_) {
+    std::scoped_lock lock(mapping_latch_);
+    // The file outgrew the mapping, unless another reader remapped it meanwhile.
+    if (offset + size > mapping_size_) {
+      Map();
+    }
+  }
+  {
+    std::shared_lock lock(mapping_latch_);
+    if (offset + size <= std::min<size_t>(mapping_size_, db_file_size_)) {
+      memcpy(data, mapping_ + offset, size);
+      return;
+    }
+  }
+  // Past the end of the file, or a file that cannot be mapped.
+  DiskManager::ReadAt(offset, size, data);
+}
+
+void DiskManagerMmap::Map() {
+  // At least double the mapping, so that a growing file is remapped a logarithmic number of times.
+  size_t size = std::max<size_t>(db_file_size_, 2 * mapping_size_);
+  size = (size + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE;
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+  if (db_fd_ == -1 || size == 0) {
+    return;
+  }
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (mapping == MAP_FAILED) {
+    LOG_WARN("cannot map the database file, reading it with pread");
+    return;
+  }
+  mapping_ = static_cast<char *>(mapping);
+  mapping_size_ = size;
+  Advise();
+}
+
+void DiskManagerMmap::Advise() {
+  if (mapping_ != nullptr) {
+    madvise(mapping_, mapping_size_, access_pattern_ == AccessPattern::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+  }
+}
+
+}  // namespace bustub
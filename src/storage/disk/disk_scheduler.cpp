@@ -0,0 +1,245 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t queue_depth) : disk_manager_(disk_manager) {
+  size_t offset;
+  if (disk_manager_->GetPageFile(0, &offset) != -1) {
+    SetUpIoUring(queue_depth);
+  }
+  if (UsesIoUring()) {
+    workers_.emplace_back(&DiskScheduler::RunIoUring, this);
+    return;
+  }
+  for (size_t i = 0; i < std::min<size_t>(queue_depth, DISK_SCHEDULER_THREADS); i++) {
+    workers_.emplace_back(&DiskScheduler::RunThreadPool, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  if (ring_fd_ != -1) {
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  {
+    std::scoped_lock lock(mutex_);
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+void DiskScheduler::RunSync(DiskRequest *request) {
+  if (request->is_write_) {
+    disk_manager_->WritePage(request->page_id_, request->data_);
+  } else {
+    disk_manager_->ReadPage(request->page_id_, request->data_);
+  }
+  request->callback_.set_value(true);
+}
+
+void DiskScheduler::RunThreadPool() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    DiskRequest request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    RunSync(&request);
+    lock.lock();
+  }
+}
+
+#ifdef __linux__
+
+void DiskScheduler::SetUpIoUring(size_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+  if (ring_fd < 0) {
+    LOG_DEBUG("io_uring is not available, falling back to worker threads");
+    return;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sq_ring_ =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    close(ring_fd);
+    return;
+  }
+  cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP) != 0
+                 ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                        IORING_OFF_CQ_RING);
+  sqes_ = cq_ring_ == MAP_FAILED
+              ? MAP_FAILED
+              : mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd);
+    return;
+  }
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  ring_entries_ = params.sq_entries;
+  in_flight_.resize(ring_entries_);
+  for (size_t slot = ring_entries_; slot > 0; slot--) {
+    free_slots_.push_back(slot - 1);
+  }
+  ring_fd_ = ring_fd;
+}
+
+void DiskScheduler::RunIoUring() {
+  // Submitted to the ring but not yet consumed by the kernel, and submitted but not yet completed.
+  unsigned unsubmitted = 0;
+  size_t num_in_flight = 0;
+  std::vector<DiskRequest> batch;
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      if (num_in_flight == 0) {
+        cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+      }
+      while (!queue_.empty() && num_in_flight + batch.size() < ring_entries_) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+
+    for (auto &request : batch) {
+      size_t offset;
+      int fd = disk_manager_->GetPageFile(request.page_id_, &offset);
+      if (fd == -1) {
+        RunSync(&request);
+        continue;
+      }
+      size_t slot = free_slots_.back();
+      free_slots_.pop_back();
+      unsigned tail = *sq_tail_;
+      unsigned index = tail & *sq_mask_;
+      auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = request.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = fd;
+      sqe->off = offset;
+      sqe->addr = reinterpret_cast<uint64_t>(request.data_);
+      sqe->len = BUSTUB_PAGE_SIZE;
+      sqe->user_data = slot;
+      sq_array_[index] = index;
+      in_flight_[slot] = std::move(request);
+      // The kernel reads the entry once it sees the new tail.
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      unsubmitted++;
+      num_in_flight++;
+    }
+    batch.clear();
+    if (num_in_flight == 0) {
+      continue;
+    }
+
+    // Submit the new requests and wait for at least one completion. Requests queued meanwhile are picked up after it.
+    auto submitted = syscall(__NR_io_uring_enter, ring_fd_, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG_DEBUG("io_uring_enter failed");
+    }
+    if (submitted > 0) {
+      unsubmitted -= static_cast<unsigned>(submitted);
+    }
+
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+      auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      size_t slot = cqe->user_data;
+      int result = cqe->res;
+      DiskRequest &request = in_flight_[slot];
+      if (!request.is_write_ && result == 0) {
+        // Past the end of the file.
+        memset(request.data_, 0, BUSTUB_PAGE_SIZE);
+        request.callback_.set_value(true);
+      } else if (result != BUSTUB_PAGE_SIZE) {
+        // An error or a short transfer, let the disk manager retry it and report the error.
+        RunSync(&request);
+      } else {
+        if (request.is_write_) {
+          disk_manager_->PageWritten(request.page_id_);
+        }
+        request.callback_.set_value(true);
+      }
+      free_slots_.push_back(slot);
+      num_in_flight--;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+}
+
+#else
+
+void DiskScheduler::SetUpIoUring(size_t /*queue_depth*/) {}
+
+void DiskScheduler::RunIoUring() {}
+
+#endif
+
+}  // namespace bustub
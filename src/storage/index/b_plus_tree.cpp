@@ -1,4 +1,6 @@
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -18,9 +20,8 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
   new_root_page_ = new BPlusTreePage();
   new_root_page_->page_id_ = INVALID_PAGE_ID;
   //  std::cout << "=========root_page_id_=========" << root_page_id_ << std::endl;
-  auto *header_page = static_cast<HeaderPage *>(bpm_->FetchPage(HEADER_PAGE_ID));
-  header_page->GetRootId(index_name_, &root_page_id_);
-  bpm_->UnpinPage(HEADER_PAGE_ID, false);
+  auto header_guard = bpm_->FetchPageBasic(HEADER_PAGE_ID);
+  static_cast<HeaderPage *>(header_guard.GetPage())->GetRootId(index_name_, &root_page_id_);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -36,10 +37,8 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
     return true;
   }
 
-  BPlusTreePage * root_page = reinterpret_cast<BPlusTreePage*>(bpm_->FetchPage(root_page_id_)->GetData()); 
-  bool empty = root_page->GetSize() == 0;
-  bpm_->UnpinPage(root_page_id_, false);
-  return empty;
+  auto root_guard = bpm_->FetchPageBasic(root_page_id_);
+  return root_guard.As<BPlusTreePage>()->GetSize() == 0;
 }
 /*****************************************************************************
  * SEARCH
@@ -69,6 +68,89 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   }
 }
 
+/*
+ * Look up a batch of keys with a single descent of the tree. The nodes the keys lead to on a level are fetched
+ * together with FetchPages(), so the misses of a level are read at once instead of one key at a time.
+ * Readers crab down as in Find(): a level stays read-latched until the next one is.
+ * @param results : the values found for each key, in the order of the keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), {});
+  if (keys.empty()) {
+    return;
+  }
+  auto latch = [](Page *page) -> ReaderWriterLatch & {
+    return reinterpret_cast<BPlusTreePage *>(page->GetData())->latch_;
+  };
+  auto release = [&](const std::vector<page_id_t> &page_ids, const std::vector<Page *> &pages) {
+    for (size_t i = 0; i < pages.size(); i++) {
+      if (pages[i] != nullptr) {
+        latch(pages[i]).RUnlock();
+        bpm_->UnpinPage(page_ids[i], false);
+      }
+    }
+  };
+
+  new_root_page_->latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    new_root_page_->latch_.RUnlock();
+    return;
+  }
+  // The distinct nodes of the current level, and for each key the position of its node among them.
+  std::vector<page_id_t> level{root_page_id_};
+  std::vector<Page *> nodes;
+  std::vector<size_t> node_of(keys.size(), 0);
+  std::vector<page_id_t> parent_level;
+  std::vector<Page *> parents;
+  while (true) {
+    nodes.assign(level.size(), nullptr);
+    bool fetched = bpm_->FetchPages(level, nodes.data());
+    for (Page *node : nodes) {
+      if (node != nullptr) {
+        latch(node).RLock();
+      }
+    }
+    if (parents.empty()) {
+      new_root_page_->latch_.RUnlock();
+    } else {
+      release(parent_level, parents);
+    }
+    if (!fetched) {
+      release(level, nodes);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the B+ tree nodes of a batch lookup");
+    }
+    if (reinterpret_cast<BPlusTreePage *>(nodes[0]->GetData())->IsLeafPage()) {
+      break;
+    }
+
+    std::unordered_map<page_id_t, size_t> children;
+    std::vector<page_id_t> next_level;
+    for (size_t i = 0; i < keys.size(); i++) {
+      auto *internal = reinterpret_cast<InternalPage *>(nodes[node_of[i]]->GetData());
+      int index = internal->IndexOfKey(keys[i], comparator_);
+      BUSTUB_ASSERT(index >= 0, "GetValues error, invalide index %d", index);
+      auto [child, inserted] = children.try_emplace(internal->ValueAt(index), next_level.size());
+      if (inserted) {
+        next_level.push_back(child->first);
+      }
+      node_of[i] = child->second;
+    }
+    parent_level.swap(level);
+    parents.swap(nodes);
+    level.swap(next_level);
+  }
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    auto *leaf = reinterpret_cast<LeafPage *>(nodes[node_of[i]]->GetData());
+    int index = leaf->IndexOfKey(keys[i], comparator_);
+    if (index != -1) {
+      (*results)[i].push_back(leaf->ValueAt(index));
+    }
+  }
+  release(level, nodes);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Find(const KeyType &key, Operation op, std::list<BPlusTreePage *> &locked_list) -> LeafPage * {
@@ -200,7 +282,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   LeafPage *page = Find(key, Operation::INSERT, locked_list);
   if(page == nullptr) {
     // page_id_t root_page_id;
-    page = reinterpret_cast<LeafPage *>(bpm_->NewPage(&root_page_id_)->GetData());
+    page = reinterpret_cast<LeafPage *>(bpm_->NewPage(&root_page_id_, NEW_SEGMENT)->GetData());
     page->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
     page->SetNextPageId(INVALID_PAGE_ID);
     UpdateRootPageId(1);
@@ -224,9 +306,11 @@ void BPLUSTREE_TYPE::InsertInLeafPage(LeafPage *page, const KeyType &key, const
     PopFromLockedPageList(locked_list, true);
     return;
   }
-  // split
+  // split, the new page goes to the segment of the tree
   page_id_t page_r_id;
-  LeafPage *page_r = reinterpret_cast<LeafPage *>(bpm_->NewPage(&page_r_id)->GetData());
+  page_id_t segment = page->GetPageId();
+  auto page_r_guard = bpm_->NewPageGuarded(&page_r_id, segment);
+  auto *page_r = page_r_guard.AsMut<LeafPage>();
   page_r->Init(page_r_id, page->GetParentPageId(), leaf_max_size_);
   int mid = page->GetMinSize();
   for (int i = mid, j = 0; i < page->GetSize(); i++, j++) {
@@ -239,13 +323,10 @@ void BPLUSTREE_TYPE::InsertInLeafPage(LeafPage *page, const KeyType &key, const
   if (page->IsRootPage()) {
     InsertInNewRoot(page->KeyAt(0), page, page_r->KeyAt(0), page_r);
     PopFromLockedPageList(locked_list, true);
-    bpm_->UnpinPage(page_r->GetPageId(), true);
   } else {
     PopFromLockedPageList(locked_list, true);
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(bpm_->FetchPage(page->GetParentPageId())->GetData());
-    InsertInInternalPage(parent_page, page_r->KeyAt(0), page_r_id, locked_list);
-    bpm_->UnpinPage(parent_page->GetPageId(), true);
-    bpm_->UnpinPage(page_r->GetPageId(), true);
+    BasicPageGuard parent_guard = bpm_->FetchPageBasic(page->GetParentPageId());
+    InsertInInternalPage(parent_guard.AsMut<InternalPage>(), page_r->KeyAt(0), page_r_id, locked_list);
   }
  
 }
@@ -258,9 +339,11 @@ void BPLUSTREE_TYPE::InsertInInternalPage(InternalPage *page, const KeyType &key
     PopFromLockedPageList(locked_list, true);
     return;
   }
-  // split
+  // split, the new page goes to the segment of the tree
   page_id_t page_r_id;
-  InternalPage *page_r = reinterpret_cast<InternalPage *>(bpm_->NewPage(&page_r_id)->GetData());
+  page_id_t segment = page->GetPageId();
+  auto page_r_guard = bpm_->NewPageGuarded(&page_r_id, segment);
+  auto *page_r = page_r_guard.AsMut<InternalPage>();
   // page_r->latch_.WLock();
   page_r->Init(page_r_id, page->GetParentPageId(), leaf_max_size_);
   int mid = page->GetMinSize();
@@ -274,13 +357,10 @@ void BPLUSTREE_TYPE::InsertInInternalPage(InternalPage *page, const KeyType &key
   if (page->IsRootPage()) {
     InsertInNewRoot(page->KeyAt(0), page, page_r->KeyAt(0), page_r);
     PopFromLockedPageList(locked_list, true);
-    bpm_->UnpinPage(page_r->GetPageId(), true);
   } else {
     PopFromLockedPageList(locked_list, true);
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(bpm_->FetchPage(page->GetParentPageId())->GetData());
-    InsertInInternalPage(parent_page, page_r->KeyAt(0), page_r->GetPageId(), locked_list);
-    bpm_->UnpinPage(parent_page->GetPageId(), true);
-    bpm_->UnpinPage(page_r->GetPageId(), true);
+    BasicPageGuard parent_guard = bpm_->FetchPageBasic(page->GetParentPageId());
+    InsertInInternalPage(parent_guard.AsMut<InternalPage>(), page_r->KeyAt(0), page_r->GetPageId(), locked_list);
   }
   
 }
@@ -289,7 +369,9 @@ void BPLUSTREE_TYPE::InsertInInternalPage(InternalPage *page, const KeyType &key
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertInNewRoot(const KeyType &key, BPlusTreePage *page, const KeyType &key_r, BPlusTreePage *page_r) {
   page_id_t root_page_id;
-  InternalPage *root_page = reinterpret_cast<InternalPage *>(bpm_->NewPage(&root_page_id)->GetData());
+  page_id_t segment = page->GetPageId();
+  auto root_guard = bpm_->NewPageGuarded(&root_page_id, segment);
+  auto *root_page = root_guard.AsMut<InternalPage>();
   root_page->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
   page->SetParentPageId(root_page_id);
   page_r->SetParentPageId(root_page_id);
@@ -297,7 +379,6 @@ void BPLUSTREE_TYPE::InsertInNewRoot(const KeyType &key, BPlusTreePage *page, co
   root_page->Insert(key_r, page_r->GetPageId(), comparator_);
   root_page_id_ = root_page_id;
   UpdateRootPageId(0);
-  bpm_->UnpinPage(root_page_id, true);
 }
 
 /*****************************************************************************
@@ -582,15 +663,11 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
   if(root_page_id_ == INVALID_PAGE_ID){
     return INDEXITERATOR_TYPE();
   }
-  BPlusTreePage *cur_page = reinterpret_cast<BPlusTreePage *>(bpm_->FetchPage(root_page_id_)->GetData());
-  BPlusTreePage *pre_page ;
-  while (!cur_page->IsLeafPage()) {
-    pre_page = cur_page;
-    InternalPage *cur_inter_page = static_cast<InternalPage *>(cur_page);
-    cur_page = reinterpret_cast<BPlusTreePage *>(bpm_->FetchPage(cur_inter_page->ValueAt(0))->GetData());
-    bpm_->UnpinPage(pre_page->GetPageId(), false);
+  auto guard = bpm_->FetchPageBasic(root_page_id_);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm_->FetchPageBasic(guard.As<InternalPage>()->ValueAt(0));
   }
-  return INDEXITERATOR_TYPE(static_cast<LeafPage *>(cur_page), bpm_);
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard));
 }
 
 /*
@@ -605,9 +682,16 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   }
   std::list<BPlusTreePage *> locked_list;
   auto *leaf_page = Find(key, Operation::FIND, locked_list);
+  if (leaf_page == nullptr) {
+    ClearLockedPageList(locked_list, Operation::FIND);
+    return INDEXITERATOR_TYPE();
+  }
   int i = leaf_page->IndexOfKey(key, comparator_);
+  // The iterator takes a pin of its own, the one Find() took goes away with the read latch.
+  auto guard = bpm_->FetchPageBasic(leaf_page->GetPageId());
+  ClearLockedPageList(locked_list, Operation::FIND);
 
-  return INDEXITERATOR_TYPE(leaf_page, bpm_, i == -1 ? 0 : i);
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), i == -1 ? 0 : i);
 }
 
 /*
@@ -620,15 +704,13 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
   if(root_page_id_ == INVALID_PAGE_ID){
     return INDEXITERATOR_TYPE();
   }
-  BPlusTreePage *pre_page;
-  BPlusTreePage *cur_page = reinterpret_cast<BPlusTreePage *>(bpm_->FetchPage(root_page_id_)->GetData());
-  while (!cur_page->IsLeafPage()) {
-    pre_page = cur_page;
-    InternalPage *cur_inter_page = static_cast<InternalPage *>(cur_page);
-    cur_page = reinterpret_cast<BPlusTreePage *>( bpm_->FetchPage(cur_inter_page->ValueAt(cur_inter_page->GetSize() - 1))->GetData());
-    bpm_->UnpinPage(pre_page->GetPageId(), false);
+  auto guard = bpm_->FetchPageBasic(root_page_id_);
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    auto inter_page = guard.As<InternalPage>();
+    guard = bpm_->FetchPageBasic(inter_page->ValueAt(inter_page->GetSize() - 1));
   }
-  return INDEXITERATOR_TYPE(static_cast<LeafPage *>(cur_page), bpm_, cur_page->GetSize());
+  int size = guard.As<BPlusTreePage>()->GetSize();
+  return INDEXITERATOR_TYPE(bpm_, std::move(guard), size);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -659,7 +741,9 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  auto *header_page = static_cast<HeaderPage *>(bpm_->FetchPage(HEADER_PAGE_ID));
+  auto header_guard = bpm_->FetchPageBasic(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(header_guard.GetPage());
+  header_guard.SetDirty();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -667,7 +751,6 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  bpm_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
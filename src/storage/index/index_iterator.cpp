@@ -2,6 +2,7 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
@@ -12,19 +13,18 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page, BufferPoolManager *bpm, int index)
-    : leaf_page_(leaf_page), bpm_(bpm), index_(index){};
-
-INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator(){
-  if(leaf_page_ != nullptr ){
-    bpm_->UnpinPage(leaf_page_->GetPageId(), false);
-  }
-}
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, BasicPageGuard guard, int index)
+    : bpm_(bpm),
+      guard_(std::move(guard)),
+      leaf_page_(guard_ ? guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>() : nullptr),
+      index_(index),
+      read_ahead_(bpm_, [](Page *page) {
+        return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetNextPageId();
+      }) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  if(leaf_page_ == nullptr ){
+  if (leaf_page_ == nullptr) {
     return true;
   }
   return leaf_page_->GetNextPageId() == INVALID_PAGE_ID && index_ >= leaf_page_->GetSize();
@@ -32,41 +32,33 @@ auto INDEXITERATOR_TYPE::IsEnd() -> bool {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator==(const IndexIterator &other) const -> bool {
-  if(leaf_page_ == nullptr || other.leaf_page_ == nullptr){
-     
-    return leaf_page_ == other.leaf_page_ ;
+  if (leaf_page_ == nullptr || other.leaf_page_ == nullptr) {
+    return leaf_page_ == other.leaf_page_;
   }
   return leaf_page_->GetPageId() == other.leaf_page_->GetPageId() && index_ == other.index_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() ->  MappingType & { return leaf_page_->At(index_); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return leaf_page_->At(index_); }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator->() ->  MappingType * { return &(leaf_page_->At(index_)); }
+auto INDEXITERATOR_TYPE::operator->() -> const MappingType * { return &(leaf_page_->At(index_)); }
 
 // Prefix increment
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   ++index_;
-  if(IsEnd()){
+  if (IsEnd()) {
     return *this;
-  } else if (index_ >= leaf_page_->GetSize()) {
-    page_id_t next_page_id = leaf_page_->GetNextPageId();
-    bpm_->UnpinPage(leaf_page_->GetPageId(), false);
-    leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(bpm_->FetchPage(next_page_id)->GetData());
+  }
+  if (index_ >= leaf_page_->GetSize()) {
+    // Assigning the guard unpins the leaf we are leaving.
+    guard_ = bpm_->FetchPageBasic(leaf_page_->GetNextPageId());
+    leaf_page_ = guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
     index_ = 0;
+    read_ahead_.Advance(leaf_page_->GetNextPageId());
   }
   return *this;
-  
-}
-
-// Postfix increment
-INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++(int) -> INDEXITERATOR_TYPE {
-  INDEXITERATOR_TYPE tmp = *this;
-  ++(*this);
-  return tmp;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
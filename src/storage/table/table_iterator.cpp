@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <utility>
 
 #include "common/exception.h"
 #include "concurrency/transaction.h"
@@ -18,10 +19,15 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap),
+      tuple_(new Tuple(rid)),
+      txn_(txn),
+      strategy_(strategy),
+      read_ahead_(table_heap->buffer_pool_manager_,
+                  [](Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); }) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true, strategy_)) {
       throw bustub::Exception("read non-existing tuple");
     }
   }
@@ -39,38 +45,34 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
+  auto cur_guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_);
+  BUSTUB_ENSURE(cur_guard, "BPM full");  // all pages are pinned
 
-  cur_page->RLatch();
+  auto cur_page = static_cast<TablePage *>(cur_guard.GetPage());
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      auto next_guard = buffer_pool_manager->FetchPageRead(cur_page->GetNextPageId(), strategy_);
+      cur_guard = std::move(next_guard);
+      cur_page = static_cast<TablePage *>(cur_guard.GetPage());
+      read_ahead_.Advance(cur_page->GetNextPageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
   }
   tuple_->rid_ = next_tuple_rid;
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  cur_guard.Drop();
 
   if (*this != table_heap_->End()) {
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true)) {
-      
-      //buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true, strategy_)) {
       throw bustub::Exception("read non-existing tuple");
     }
   }
- 
+
   return *this;
 }
 
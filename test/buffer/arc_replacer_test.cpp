@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include "gtest/gtest.h"
+#include "replacer_cache.h"
+
+namespace bustub {
+
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([](frame_id_t frame_id) { return true; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+}  // namespace
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: fill the pool, then hit 0 and 1. The hand of T1 moves them over to T2 and evicts 2, then 3.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.Admit(frame_id, frame_id);
+  }
+  arc_replacer.RecordAccess(0);
+  arc_replacer.RecordAccess(1);
+  EXPECT_EQ(2, Evict(&arc_replacer));
+  arc_replacer.Admit(2, 4);
+  EXPECT_EQ(3, Evict(&arc_replacer));
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // Scenario: page 2 is missed again while in B1, T1 should grow. It goes to T2.
+  arc_replacer.Admit(3, 2);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+  EXPECT_EQ(2, Evict(&arc_replacer));
+
+  // Scenario: same for page 3. T1 is empty now, the next victim comes from T2.
+  arc_replacer.Admit(2, 3);
+  EXPECT_EQ(2, arc_replacer.GetTarget());
+  EXPECT_EQ(0, Evict(&arc_replacer));
+
+  // Scenario: page 0 is missed again while in B2, T1 should shrink.
+  arc_replacer.Admit(0, 0);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+}
+
+TEST(ARCReplacerTest, ScanResistance) {
+  // Four hot pages are accessed twice before every scan of six new pages. Their reuse distance is longer than the pool,
+  // so LRU misses them every time. ARC moves them to T2 on their second access, and evicts the scan from T1.
+  const size_t num_frames = 8;
+  ARCReplacer arc_replacer(num_frames);
+  ReplacerCache cache(&arc_replacer, num_frames);
+  page_id_t next_page_id = 100;
+  size_t hot_misses = 0;
+  for (int round = 0; round < 50; round++) {
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      if (!cache.Access(page_id) && round > 0) {
+        hot_misses++;
+      }
+      cache.Access(page_id);
+    }
+    for (int i = 0; i < 6; i++) {
+      cache.Access(next_page_id++);
+    }
+  }
+  EXPECT_EQ(0, hot_misses);
+}
+
+}  // namespace bustub
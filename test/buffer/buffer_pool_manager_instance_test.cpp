@@ -12,14 +12,23 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
 #include <random>
 #include <string>
 #include <set>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "common/util/tasks_util.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -533,4 +542,916 @@ TEST(BufferPoolManagerInstanceTest, New_Fetch_Delete) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, EvictionOrder) {
+  const std::string db_name = "test.db";
+  const size_t pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  auto is_resident = [&](page_id_t page_id) {
+    Page *frames = bpm->GetFrames();
+    for (size_t i = 0; i < pool_size; i++) {
+      if (frames[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+  // Page 0 and page 2 get a second access and a finite backward k-distance, page 2 being the most recent one.
+  for (page_id_t page_id : {0, 2}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id : {3, 1, 2, 0}) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Pages with +inf backward k-distance go first, earliest access first, regardless of unpin order.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_FALSE(is_resident(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_FALSE(is_resident(3));
+  // Then the page with the largest backward k-distance.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_FALSE(is_resident(0));
+  EXPECT_TRUE(is_resident(2));
+
+  // A pinned page is never a victim.
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_FALSE(is_resident(2));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk whose reads of one page block until they are released, to catch I/O done under the pool latch. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit BlockingDiskManager(page_id_t blocked_page_id) : blocked_page_id_(blocked_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == blocked_page_id_) {
+      read_started_.set_value();
+      release_.get_future().wait();
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::promise<void> read_started_;
+  std::promise<void> release_;
+
+ private:
+  page_id_t blocked_page_id_;
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, IoOutsidePoolLatch) {
+  const size_t pool_size = 3;
+  const size_t k = 2;
+
+  auto *disk_manager = new BlockingDiskManager(0);
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  // Page 0 is written back and evicted, then read again by a thread that gets stuck on the disk.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  std::thread loader([&] {
+    auto *page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_STREQ("page 0", page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  });
+  disk_manager->read_started_.get_future().wait();
+
+  // Buffer hits, unpins and flushes of other pages go on while the read is in flight.
+  auto *page2 = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page2);
+  EXPECT_STREQ("page 2", page2->GetData());
+  EXPECT_TRUE(bpm->FlushPage(2));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+
+  // A second fetcher of the page being read waits on the frame and sees the data once it is in.
+  std::thread waiter([&] {
+    auto *page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_STREQ("page 0", page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  disk_manager->release_.set_value();
+  loader.join();
+  waiter.join();
+
+  EXPECT_EQ(0, bpm->GetFrames()[0].GetPinCount() + bpm->GetFrames()[1].GetPinCount() +
+                   bpm->GetFrames()[2].GetPinCount());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitsAndEvictions) {
+  const size_t pool_size = 8;
+  const size_t k = 2;
+  const page_id_t num_pages = 12;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+
+  // Hits pin frames without the pool latch while misses evict around them. A pinned page is never remapped, and every
+  // pin is dropped exactly once.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> hot(0, 3);
+      std::uniform_int_distribution<page_id_t> any(0, num_pages - 1);
+      for (int i = 0; i < 2000; i++) {
+        page_id_t page_id = i % 2 == 0 ? hot(gen) : any(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 7 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetFrames()[i].GetPinCount());
+  }
+  EXPECT_TRUE(bpm->Check());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, Resize) {
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager, k);
+
+  // Growing adds free frames.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 10; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->Resize(20));
+  EXPECT_EQ(20, bpm->GetPoolSize());
+  for (size_t i = 0; i < 10; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Shrinking evicts the pages above the new size, and writes them back.
+  EXPECT_TRUE(bpm->Resize(5));
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(5));
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(BUFFER_POOL_MAX_FRAMES + 1));
+
+  // A shrink waits for the pages above the new size to be unpinned.
+  std::atomic<bool> resized{false};
+  std::thread resizer([&] {
+    EXPECT_TRUE(bpm->Resize(2));
+    resized = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(resized);
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  resizer.join();
+  EXPECT_TRUE(resized);
+  EXPECT_EQ(2, bpm->GetPoolSize());
+
+  // The frames released by a shrink can be used again.
+  EXPECT_TRUE(bpm->Resize(8));
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentResize) {
+  const size_t k = 2;
+  const page_id_t num_pages = 64;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(16, disk_manager, k);
+
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+
+  // The pool grows and shrinks under fetches, hits and dirty unpins. No page is lost or mixed up.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<page_id_t> any(0, num_pages - 1);
+      while (!done) {
+        page_id_t page_id = any(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, page_id % 3 == 0));
+      }
+    });
+  }
+  for (size_t new_size : {64, 8, 32, 4, 128, 16, 200, 6}) {
+    EXPECT_TRUE(bpm->Resize(new_size));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(6, bpm->GetPoolSize());
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    EXPECT_EQ(0, bpm->GetFrames()[i].GetPinCount());
+  }
+  EXPECT_TRUE(bpm->Check());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, PageCleaner) {
+  const size_t pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+  }
+  // Pinned pages are left alone, the others are written back a batch at a time until none is dirty.
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(pool_size); page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->StartPageCleaner(4, 0.0);
+
+  auto count_dirty = [&] {
+    size_t dirty = 0;
+    for (size_t i = 0; i < pool_size; i++) {
+      dirty += bpm->GetFrames()[i].IsDirty() ? 1 : 0;
+    }
+    return dirty;
+  };
+  for (int i = 0; i < 100 && count_dirty() > 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(1, count_dirty());
+  EXPECT_TRUE(bpm->GetFrames()[0].IsDirty());
+
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(pool_size); page_id++) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(data));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchPages) {
+  const size_t pool_size = 5;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  // Pages written behind the back of the BPM, so that they do not collide with the ids NewPage() hands out.
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 100; page_id < 104; page_id++) {
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+
+  auto resident = [&] {
+    std::set<page_id_t> page_ids;
+    for (size_t i = 0; i < pool_size; i++) {
+      if (bpm->GetFrames()[i].GetPageId() != INVALID_PAGE_ID) {
+        page_ids.insert(bpm->GetFrames()[i].GetPageId());
+      }
+    }
+    return page_ids;
+  };
+
+  auto pinned = [&] {
+    size_t num_pinned = 0;
+    for (size_t i = 0; i < pool_size; i++) {
+      num_pinned += bpm->GetFrames()[i].GetPinCount() > 0 ? 1 : 0;
+    }
+    return num_pinned;
+  };
+
+  // Prefetched pages are read in the background and left unpinned. A batch is resident before it is unpinned.
+  bpm->PrefetchPages({100, 101, 102, 103});
+  for (int i = 0; i < 100 && (resident().size() < 4 || pinned() > 0); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ((std::set<page_id_t>{100, 101, 102, 103}), resident());
+  for (size_t i = 0; i < pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetFrames()[i].GetPinCount());
+  }
+
+  // Fetching them is a hit, and they can be evicted like any other unpinned page.
+  for (page_id_t page_id = 100; page_id < 104; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < pool_size; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Once every frame is pinned, prefetches are dropped instead of waiting.
+  disk_manager->WritePage(110, data);
+  bpm->PrefetchPages({110});
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0, resident().count(110));
+  for (page_id_t page_id : resident()) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ScanStrategy) {
+  const size_t pool_size = 10;
+  const size_t k = 2;
+  const size_t ring_size = 3;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  // Three hot pages with k accesses each.
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // A scan over twice as many pages as the pool holds, touching every page once per "tuple".
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 100; page_id < 120; page_id++) {
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  BufferAccessStrategy strategy(ring_size);
+  for (page_id_t page_id = 100; page_id < 120; page_id++) {
+    for (int tuple = 0; tuple < 3; tuple++) {
+      auto *page = bpm->FetchPage(page_id, &strategy);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // The scan recycled its ring, the hot pages and the free frames are untouched.
+  auto resident = [&] {
+    std::set<page_id_t> page_ids;
+    for (size_t i = 0; i < pool_size; i++) {
+      if (bpm->GetFrames()[i].GetPageId() != INVALID_PAGE_ID) {
+        page_ids.insert(bpm->GetFrames()[i].GetPageId());
+      }
+    }
+    return page_ids;
+  };
+  EXPECT_EQ((std::set<page_id_t>{0, 1, 2, 117, 118, 119}), resident());
+
+  // A page someone else uses leaves the ring for good.
+  ASSERT_NE(nullptr, bpm->FetchPage(118));
+  EXPECT_TRUE(bpm->UnpinPage(118, false));
+  for (page_id_t page_id = 120; page_id < 123; page_id++) {
+    disk_manager->WritePage(page_id, data);
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, &strategy));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ((std::set<page_id_t>{0, 1, 2, 118, 120, 121, 122}), resident());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, PageGuard) {
+  const size_t pool_size = 5;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(page, guard.GetPage());
+    EXPECT_EQ(1, page->GetPinCount());
+    // Moving hands the pin over, it is released once.
+    auto moved = std::move(guard);
+    EXPECT_FALSE(guard);  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(moved.GetDataMut(), BUSTUB_PAGE_SIZE, "guarded");
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    auto guard1 = bpm->FetchPageRead(page_id);
+    auto guard2 = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_EQ("guarded", std::string(guard1.GetData()));
+    guard1.Drop();
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    // Reassigning a guard releases the page it held first.
+    guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    auto write_guard = guard.UpgradeWrite();
+    EXPECT_FALSE(guard);  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_FALSE(page->IsDirty());
+
+  // The latches were released: a write latch can be taken again.
+  page->WLatch();
+  page->WUnlatch();
+
+  page_id_t new_page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&new_page_id).UpgradeWrite();
+    ASSERT_TRUE(guard);
+    EXPECT_EQ(new_page_id, guard.PageId());
+    guard.AsMut<int>()[0] = 42;
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  EXPECT_EQ(42, bpm->FetchPageRead(new_page_id).As<int>()[0]);
+  EXPECT_TRUE(bpm->DeletePage(new_page_id));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Counts the reads and writes, to check that runs of pages are read and written with one call each. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    page_reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  void ReadPages(page_id_t first_page_id, size_t num_pages, char *page_data) override {
+    batch_reads_++;
+    for (size_t i = 0; i < num_pages; i++) {
+      DiskManagerUnlimitedMemory::ReadPage(first_page_id + static_cast<page_id_t>(i), page_data + i * BUSTUB_PAGE_SIZE);
+    }
+  }
+
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    page_writes_++;
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  void WritePages(page_id_t first_page_id, size_t num_pages, const char *const *page_data) override {
+    batch_writes_++;
+    for (size_t i = 0; i < num_pages; i++) {
+      DiskManagerUnlimitedMemory::WritePage(first_page_id + static_cast<page_id_t>(i), page_data[i]);
+    }
+  }
+
+  std::atomic<int> page_reads_{0};
+  std::atomic<int> batch_reads_{0};
+  std::atomic<int> page_writes_{0};
+  std::atomic<int> batch_writes_{0};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPages) {
+  const size_t pool_size = 8;
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+
+  // Pages 0-11 on disk, each one starting with its id. Pages 2 to 5 are not resident, pages 0, 1 and 9 are.
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 12; page_id++) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  bpm->FlushAllPages();
+  disk_manager->page_reads_ = 0;
+  disk_manager->batch_reads_ = 0;
+  auto stats = bpm->GetStats();
+
+  // Scenario: hits, a run of misses next to each other on disk, a lone miss, and a page listed twice.
+  std::vector<page_id_t> page_ids{0, 3, 2, 1, 9, 5, 3};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_TRUE(bpm->FetchPages(page_ids, pages.data()));
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(std::to_string(page_ids[i]), pages[i]->GetData());
+  }
+  EXPECT_EQ(pages[1], pages[6]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(1, disk_manager->batch_reads_);
+  EXPECT_EQ(1, disk_manager->page_reads_);
+  EXPECT_EQ(stats.misses_ + 3, bpm->GetStats().misses_);
+  EXPECT_EQ(stats.hits_ + 4, bpm->GetStats().hits_);
+
+  // Scenario: two frames are left for three pages that are not resident, the last one cannot be fetched.
+  std::vector<page_id_t> more_page_ids{20, 21, 22};
+  std::vector<Page *> more_pages(more_page_ids.size());
+  EXPECT_FALSE(bpm->FetchPages(more_page_ids, more_pages.data()));
+  EXPECT_NE(nullptr, more_pages[0]);
+  EXPECT_NE(nullptr, more_pages[1]);
+  EXPECT_EQ(nullptr, more_pages[2]);
+  EXPECT_TRUE(bpm->UnpinPages({20, 21}, false));
+
+  // Scenario: UnpinPages() drops one pin per listed page.
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+  for (size_t i = 0; i < pool_size; i++) {
+    EXPECT_EQ(0, bpm->GetFrames()[i].GetPinCount());
+  }
+  EXPECT_FALSE(bpm->UnpinPages({0}, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllPagesWritesDirtyRuns) {
+  const size_t pool_size = 8;
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < pool_size; i++) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: all the pages are dirty and next to each other, one write.
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->batch_writes_);
+  EXPECT_EQ(0, disk_manager->page_writes_);
+
+  // Scenario: clean pages are skipped, the dirty ones are written in two runs, 2-3 and 6.
+  for (page_id_t page_id : {6, 3, 2}) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d again", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  disk_manager->batch_writes_ = 0;
+  auto stats = bpm->GetStats();
+  bpm->FlushAllPages();
+  EXPECT_EQ(2, disk_manager->batch_writes_);
+  EXPECT_EQ(stats.flushes_ + 3, bpm->GetStats().flushes_);
+  char buf[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(3, buf);
+  EXPECT_STREQ("page 3 again", buf);
+  disk_manager->ReadPage(4, buf);
+  EXPECT_STREQ("page 4", buf);
+
+  // Scenario: nothing is dirty, nothing is written.
+  disk_manager->batch_writes_ = 0;
+  bpm->FlushAllPages();
+  EXPECT_EQ(0, disk_manager->batch_writes_);
+  EXPECT_EQ(0, disk_manager->page_writes_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DumpAndWarmUp) {
+  const size_t pool_size = 5;
+  const size_t k = 2;
+  const auto num_pages = static_cast<page_id_t>(2 * pool_size);
+  const std::string dump_file = "buffer_pool_manager_instance_test.pool";
+
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+
+  // Pages 0..9 are written, which leaves 5..9 in the pool. They are then accessed twice more, in reverse order.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = num_pages - 1; page_id >= static_cast<page_id_t>(pool_size); page_id--) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  bpm->FlushAllPages();
+  ASSERT_TRUE(bpm->DumpPool(dump_file));
+  delete bpm;
+
+  // A restart loads the five pages with a single read, before any fetch.
+  disk_manager->page_reads_ = 0;
+  bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+  EXPECT_EQ(pool_size, bpm->WarmUp(dump_file));
+  EXPECT_EQ(1, disk_manager->batch_reads_);
+  for (page_id_t page_id = 5; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, disk_manager->page_reads_);
+
+  // Warming up again does nothing, the pages are resident.
+  EXPECT_EQ(0, bpm->WarmUp(dump_file));
+  EXPECT_EQ(0, bpm->WarmUp("no_such_file.pool"));
+  delete bpm;
+
+  // The replacement order survives the restart: the pages are evicted in reverse order by backward k-distance, where
+  // loading them by page id would evict them in page id order. The pages fetched in their place stay pinned, so that
+  // each fetch evicts a restored page.
+  bpm = new BufferPoolManagerInstance(pool_size, disk_manager, k);
+  EXPECT_EQ(pool_size, bpm->WarmUp(dump_file));
+  std::vector<page_id_t> evicted;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(pool_size); i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    for (page_id_t page_id = 5; page_id < num_pages; page_id++) {
+      bool resident = false;
+      for (size_t j = 0; j < pool_size; j++) {
+        resident = resident || bpm->GetFrames()[j].GetPageId() == page_id;
+      }
+      if (!resident && std::find(evicted.begin(), evicted.end(), page_id) == evicted.end()) {
+        evicted.push_back(page_id);
+      }
+    }
+  }
+  EXPECT_EQ((std::vector<page_id_t>{9, 8, 7, 6, 5}), evicted);
+
+  remove(dump_file.c_str());
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReplacementPolicies) {
+  // Every policy under concurrent hits, misses, deletes and a resize. Pinned pages are never evicted, and every page
+  // reads back what was written to it.
+  const size_t pool_size = 8;
+  const page_id_t num_pages = 24;
+  for (auto type : {ReplacerType::LRU_K, ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::ARC,
+                    ReplacerType::TWO_QUEUE, ReplacerType::CLOCK_PRO}) {
+    SCOPED_TRACE(ReplacerTypeToString(type));
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager, LRUK_REPLACER_K, nullptr, type);
+
+    char data[BUSTUB_PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+      disk_manager->WritePage(page_id, data);
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 gen(t);
+        std::uniform_int_distribution<page_id_t> hot(0, 3);
+        std::uniform_int_distribution<page_id_t> any(0, num_pages - 1);
+        for (int i = 0; i < 2000; i++) {
+          page_id_t page_id = i % 2 == 0 ? hot(gen) : any(gen);
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+          EXPECT_TRUE(bpm->UnpinPage(page_id, i % 7 == 0));
+          if (i % 101 == 0) {
+            // The page is read back from disk, where it was written if it was dirty.
+            bpm->FlushPage(page_id);
+            bpm->DeletePage(page_id);
+          }
+        }
+      });
+    }
+    EXPECT_TRUE(bpm->Resize(pool_size / 2));
+    EXPECT_TRUE(bpm->Resize(pool_size));
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < pool_size; i++) {
+      EXPECT_EQ(0, bpm->GetFrames()[i].GetPinCount());
+    }
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, Stats) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+
+  // Scenario: page 0 is unpinned dirty, page 1 stays pinned. Page 2 evicts page 0, which is written back first.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: every frame is pinned, no page can be created.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: page 1 is a hit. Page 0 is a miss that evicts page 1, which is written back too: new pages are dirty.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->FlushPage(0));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(3, stats.new_pages_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.dirty_evictions_);
+  EXPECT_EQ(1, stats.flushes_);
+  EXPECT_EQ(1, stats.pinned_failures_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletedPagesAreReused) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a deleted page id is handed out again, the others stay allocated.
+  EXPECT_TRUE(bpm->DeletePage(2));
+  EXPECT_FALSE(disk_manager->IsAllocated(2));
+  EXPECT_TRUE(disk_manager->IsAllocated(3));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(4, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(4, false));
+
+  // Scenario: a new buffer pool on the same disk keeps the allocations.
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(5, page_id_temp);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, AlignedFrameData) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+
+  // Scenario: the frames are page-aligned and side by side.
+  page_id_t page_id_temp;
+  std::vector<Page *> pages;
+  for (int i = 0; i < 4; i++) {
+    pages.push_back(bpm->NewPage(&page_id_temp));
+    ASSERT_NE(nullptr, pages.back());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages.back()->GetData()) % BUSTUB_PAGE_SIZE);
+  }
+  std::set<char *> data;
+  for (auto *page : pages) {
+    data.insert(page->GetData());
+  }
+  EXPECT_EQ(4, data.size());
+  EXPECT_EQ(3 * BUSTUB_PAGE_SIZE, *data.rbegin() - *data.begin());
+
+  // Scenario: a frame released by a shrink comes back zeroed when the pool grows again.
+  memset(bpm->GetFrames()[3].GetData(), 'x', BUSTUB_PAGE_SIZE);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->Resize(3));
+  EXPECT_TRUE(bpm->Resize(4));
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  EXPECT_EQ(0, memcmp(zeros, bpm->GetFrames()[3].GetData(), BUSTUB_PAGE_SIZE));
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
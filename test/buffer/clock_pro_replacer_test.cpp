@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer_test.cpp
+//
+// Identification: test/buffer/clock_pro_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer_cache.h"
+
+namespace bustub {
+
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([](frame_id_t frame_id) { return true; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+}  // namespace
+
+TEST(ClockProReplacerTest, SampleTest) {
+  // One resident cold page is the initial target.
+  ClockProReplacer clock_pro_replacer(4);
+  EXPECT_EQ(1, clock_pro_replacer.GetColdTarget());
+
+  // Scenario: fill the pool, then hit 1. The cold hand evicts 0, then promotes 1 to hot and evicts 2.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    clock_pro_replacer.Admit(frame_id, frame_id);
+  }
+  clock_pro_replacer.RecordAccess(1);
+  EXPECT_EQ(0, Evict(&clock_pro_replacer));
+  clock_pro_replacer.Admit(0, 4);
+  EXPECT_EQ(2, Evict(&clock_pro_replacer));
+
+  // Scenario: page 0 is missed during its test period. It is admitted hot, and cold pages get more room.
+  clock_pro_replacer.Admit(2, 0);
+  EXPECT_EQ(2, clock_pro_replacer.GetColdTarget());
+
+  // Scenario: the cold pages go first, which leaves the hot frames 2 and 1.
+  EXPECT_EQ(3, Evict(&clock_pro_replacer));
+  EXPECT_EQ(0, Evict(&clock_pro_replacer));
+  std::vector<frame_id_t> hot;
+  clock_pro_replacer.ForEach([&](frame_id_t frame_id) {
+    hot.push_back(frame_id);
+    return true;
+  });
+  EXPECT_EQ((std::vector<frame_id_t>{2, 1}), hot);
+}
+
+TEST(ClockProReplacerTest, ScanResistance) {
+  // Four hot pages are accessed before every scan of six new pages. Their reuse distance is longer than the pool, so
+  // LRU misses them every time. CLOCK-Pro catches them in their test period, and keeps them hot from then on. The
+  // scanned pages end their test periods without an access, which shrinks the share of cold pages back.
+  const size_t num_frames = 8;
+  ClockProReplacer clock_pro_replacer(num_frames);
+  ReplacerCache cache(&clock_pro_replacer, num_frames);
+  page_id_t next_page_id = 100;
+  size_t hot_misses = 0;
+  for (int round = 0; round < 50; round++) {
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      if (!cache.Access(page_id) && round >= 5) {
+        hot_misses++;
+      }
+    }
+    for (int i = 0; i < 6; i++) {
+      cache.Access(next_page_id++);
+    }
+  }
+  EXPECT_EQ(0, hot_misses);
+  EXPECT_EQ(1, clock_pro_replacer.GetColdTarget());
+}
+
+}  // namespace bustub
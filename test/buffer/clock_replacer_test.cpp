@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <set>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -19,44 +20,57 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer, const std::set<frame_id_t> &pinned) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([&](frame_id_t frame_id) { return pinned.count(frame_id) == 0; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+/** @return the number of tracked frames that can be evicted */
+auto Size(Replacer *replacer, const std::set<frame_id_t> &pinned) -> size_t {
+  size_t size = 0;
+  replacer->ForEach([&](frame_id_t frame_id) {
+    size += pinned.count(frame_id) == 0 ? 1 : 0;
+    return true;
+  });
+  return size;
+}
+
+}  // namespace
+
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
+  std::set<frame_id_t> pinned;
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
-  EXPECT_EQ(6, clock_replacer.Size());
+  // Scenario: add six elements to the replacer.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    clock_replacer.Admit(frame_id, frame_id);
+  }
+  EXPECT_EQ(6, Size(&clock_replacer, pinned));
 
   // Scenario: get three victims from the clock.
-  int value;
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(3, value);
-
-  // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
-  EXPECT_EQ(2, clock_replacer.Size());
+  EXPECT_EQ(1, Evict(&clock_replacer, pinned));
+  EXPECT_EQ(2, Evict(&clock_replacer, pinned));
+  EXPECT_EQ(3, Evict(&clock_replacer, pinned));
+
+  // Scenario: pin 4, which is hit.
+  pinned.insert(4);
+  clock_replacer.RecordAccess(4);
+  EXPECT_EQ(2, Size(&clock_replacer, pinned));
 
   // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
+  pinned.erase(4);
 
   // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(4, value);
+  EXPECT_EQ(5, Evict(&clock_replacer, pinned));
+  EXPECT_EQ(6, Evict(&clock_replacer, pinned));
+  EXPECT_EQ(4, Evict(&clock_replacer, pinned));
+  EXPECT_EQ(-1, Evict(&clock_replacer, pinned));
 }
 
 }  // namespace bustub
@@ -5,6 +5,7 @@
 #include "buffer/lru_k_replacer.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <memory>
 #include <random>
@@ -16,23 +17,38 @@
 
 namespace bustub {
 
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer, const std::set<frame_id_t> &pinned) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([&](frame_id_t frame_id) { return pinned.count(frame_id) == 0; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+/** @return the number of tracked frames that can be evicted */
+auto Size(Replacer *replacer, const std::set<frame_id_t> &pinned) -> size_t {
+  size_t size = 0;
+  replacer->ForEach([&](frame_id_t frame_id) {
+    size += pinned.count(frame_id) == 0 ? 1 : 0;
+    return true;
+  });
+  return size;
+}
+
+}  // namespace
+
 TEST(LRUKReplacerTest, SampleTest) {
   LRUKReplacer lru_replacer(7, 2);
+  std::set<frame_id_t> pinned{6};
 
-  // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is non-evictable.
-  lru_replacer.RecordAccess(1);
-  lru_replacer.RecordAccess(2);
-  lru_replacer.RecordAccess(3);
-  lru_replacer.RecordAccess(4);
-  lru_replacer.RecordAccess(5);
-  lru_replacer.RecordAccess(6);
-  lru_replacer.SetEvictable(1, true);
-  lru_replacer.SetEvictable(2, true);
-  lru_replacer.SetEvictable(3, true);
-  lru_replacer.SetEvictable(4, true);
-  lru_replacer.SetEvictable(5, true);
-  lru_replacer.SetEvictable(6, false);
-  ASSERT_EQ(5, lru_replacer.Size());
+  // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is pinned.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.Admit(frame_id, frame_id);
+  }
+  ASSERT_EQ(5, Size(&lru_replacer, pinned));
 
   // Scenario: Insert access history for frame 1. Now frame 1 has two access histories.
   // All other frames have max backward k-dist. The order of eviction is [2,3,4,5,1].
@@ -40,61 +56,124 @@ TEST(LRUKReplacerTest, SampleTest) {
 
   // Scenario: Evict three pages from the replacer. Elements with max k-distance should be popped
   // first based on LRU.
-  int value;
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(2, value);
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(3, value);
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(4, value);
-  ASSERT_EQ(2, lru_replacer.Size());
+  ASSERT_EQ(2, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(3, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(4, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(2, Size(&lru_replacer, pinned));
 
   // Scenario: Now replacer has frames [5,1].
   // Insert new frames 3, 4, and update access history for 5. We should end with [3,1,5,4]
-  lru_replacer.RecordAccess(3);
-  lru_replacer.RecordAccess(4);
+  lru_replacer.Admit(3, 3);
+  lru_replacer.Admit(4, 4);
   lru_replacer.RecordAccess(5);
   lru_replacer.RecordAccess(4);
-  lru_replacer.SetEvictable(3, true);
-  lru_replacer.SetEvictable(4, true);
-  ASSERT_EQ(4, lru_replacer.Size());
+  ASSERT_EQ(4, Size(&lru_replacer, pinned));
 
   // Scenario: continue looking for victims. We expect 3 to be evicted next.
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(3, value);
-  ASSERT_EQ(3, lru_replacer.Size());
+  ASSERT_EQ(3, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(3, Size(&lru_replacer, pinned));
 
-  // Set 6 to be evictable. 6 Should be evicted next since it has max backward k-dist.
-  lru_replacer.SetEvictable(6, true);
-  ASSERT_EQ(4, lru_replacer.Size());
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(6, value);
-  ASSERT_EQ(3, lru_replacer.Size());
+  // Unpin 6. 6 Should be evicted next since it has max backward k-dist.
+  pinned.erase(6);
+  ASSERT_EQ(4, Size(&lru_replacer, pinned));
+  ASSERT_EQ(6, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(3, Size(&lru_replacer, pinned));
 
   // Now we have [1,5,4]. Continue looking for victims.
-  lru_replacer.SetEvictable(1, false);
-  ASSERT_EQ(2, lru_replacer.Size());
-  ASSERT_EQ(true, lru_replacer.Evict(&value));
-  ASSERT_EQ(5, value);
-  ASSERT_EQ(1, lru_replacer.Size());
+  pinned.insert(1);
+  ASSERT_EQ(2, Size(&lru_replacer, pinned));
+  ASSERT_EQ(5, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(1, Size(&lru_replacer, pinned));
 
   // Update access history for 1. Now we have [4,1]. Next victim is 4.
   lru_replacer.RecordAccess(1);
   lru_replacer.RecordAccess(1);
-  lru_replacer.SetEvictable(1, true);
-  ASSERT_EQ(2, lru_replacer.Size());
-  ASSERT_EQ(true, lru_replacer.Evict(&value));
-  ASSERT_EQ(value, 4);
+  pinned.erase(1);
+  ASSERT_EQ(2, Size(&lru_replacer, pinned));
+  ASSERT_EQ(4, Evict(&lru_replacer, pinned));
 
-  ASSERT_EQ(1, lru_replacer.Size());
-  lru_replacer.Evict(&value);
-  ASSERT_EQ(value, 1);
-  ASSERT_EQ(0, lru_replacer.Size());
+  ASSERT_EQ(1, Size(&lru_replacer, pinned));
+  ASSERT_EQ(1, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(0, Size(&lru_replacer, pinned));
 
   // These operations should not modify size
-  ASSERT_EQ(false, lru_replacer.Evict(&value));
-  ASSERT_EQ(0, lru_replacer.Size());
-  lru_replacer.Remove(1);
-  ASSERT_EQ(0, lru_replacer.Size());
+  ASSERT_EQ(-1, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(0, Size(&lru_replacer, pinned));
 }
+
+TEST(LRUKReplacerTest, HistoryWrapsAround) {
+  LRUKReplacer lru_replacer(3, 3);
+  std::set<frame_id_t> pinned;
+
+  // Timestamps 1..3, then 4..18 in rounds of 0, 1, 2: every history has wrapped around, and the k-th previous accesses
+  // are 10, 11 and 12.
+  for (frame_id_t frame_id = 0; frame_id < 3; frame_id++) {
+    lru_replacer.Admit(frame_id, frame_id);
+  }
+  for (int round = 0; round < 5; round++) {
+    for (frame_id_t frame_id = 0; frame_id < 3; frame_id++) {
+      lru_replacer.RecordAccess(frame_id);
+    }
+  }
+
+  // Scenario: frame 0 is accessed three times (19..21), frame 1 once (22). Their k-th previous accesses become 19 and
+  // 14, so the eviction order is [2,1,0].
+  for (int i = 0; i < 3; i++) {
+    lru_replacer.RecordAccess(0);
+  }
+  lru_replacer.RecordAccess(1);
+  ASSERT_EQ(2, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(1, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(0, Evict(&lru_replacer, pinned));
+
+  // Scenario: a frame admitted again starts with an empty history, below k accesses.
+  lru_replacer.Admit(0, 5);
+  lru_replacer.Admit(1, 6);
+  for (int i = 0; i < 3; i++) {
+    lru_replacer.RecordAccess(0);
+  }
+  ASSERT_EQ(1, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(0, Evict(&lru_replacer, pinned));
+  ASSERT_EQ(-1, Evict(&lru_replacer, pinned));
+}
+
+TEST(LRUKReplacerTest, ConcurrentAccesses) {
+  // Hits record their accesses without the pool latch while victims are picked. A frame hit between two victim
+  // searches is refiled and passed over.
+  const size_t num_frames = 64;
+  LRUKReplacer lru_replacer(num_frames, 2);
+  for (size_t i = 0; i < num_frames; i++) {
+    lru_replacer.Admit(static_cast<frame_id_t>(i), static_cast<page_id_t>(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<frame_id_t> any(1, num_frames - 1);
+      while (!done) {
+        lru_replacer.RecordAccess(any(gen));
+      }
+    });
+  }
+  for (int i = 0; i < 1000; i++) {
+    frame_id_t frame_id = lru_replacer.Victim([](frame_id_t frame_id) { return true; });
+    ASSERT_NE(-1, frame_id);
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 1; i < num_frames; i++) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+  }
+
+  // Frame 0 was never hit: it is the only one left with +inf backward k-distance.
+  EXPECT_EQ(0, lru_replacer.Victim([](frame_id_t frame_id) { return true; }));
+  std::set<frame_id_t> visited;
+  lru_replacer.ForEach([&](frame_id_t frame_id) { return visited.insert(frame_id).second; });
+  EXPECT_EQ(num_frames, visited.size());
+}
+
 }  // namespace bustub
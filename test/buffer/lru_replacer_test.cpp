@@ -11,52 +11,88 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstdio>
+#include <set>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
+#include "replacer_cache.h"
 
 namespace bustub {
 
-TEST(LRUReplacerTest, DISABLED_SampleTest) {
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer, const std::set<frame_id_t> &pinned) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([&](frame_id_t frame_id) { return pinned.count(frame_id) == 0; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+/** @return the number of tracked frames that can be evicted */
+auto Size(Replacer *replacer, const std::set<frame_id_t> &pinned) -> size_t {
+  size_t size = 0;
+  replacer->ForEach([&](frame_id_t frame_id) {
+    size += pinned.count(frame_id) == 0 ? 1 : 0;
+    return true;
+  });
+  return size;
+}
+
+}  // namespace
+
+TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
+  std::set<frame_id_t> pinned;
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  lru_replacer.Unpin(1);
-  lru_replacer.Unpin(2);
-  lru_replacer.Unpin(3);
-  lru_replacer.Unpin(4);
-  lru_replacer.Unpin(5);
-  lru_replacer.Unpin(6);
-  lru_replacer.Unpin(1);
-  EXPECT_EQ(6, lru_replacer.Size());
+  // Scenario: add six elements to the replacer.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.Admit(frame_id, frame_id);
+  }
+  EXPECT_EQ(6, Size(&lru_replacer, pinned));
 
   // Scenario: get three victims from the lru.
-  int value;
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(1, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(2, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(3, value);
-
-  // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  lru_replacer.Pin(3);
-  lru_replacer.Pin(4);
-  EXPECT_EQ(2, lru_replacer.Size());
-
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  lru_replacer.Unpin(4);
+  EXPECT_EQ(1, Evict(&lru_replacer, pinned));
+  EXPECT_EQ(2, Evict(&lru_replacer, pinned));
+  EXPECT_EQ(3, Evict(&lru_replacer, pinned));
+
+  // Scenario: pin 4, which is hit.
+  pinned.insert(4);
+  lru_replacer.RecordAccess(4);
+  EXPECT_EQ(2, Size(&lru_replacer, pinned));
+
+  // Scenario: unpin 4. We expect that 4 becomes the most recently used frame.
+  pinned.erase(4);
 
   // Scenario: continue looking for victims. We expect these victims.
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(6, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(4, value);
+  EXPECT_EQ(5, Evict(&lru_replacer, pinned));
+  EXPECT_EQ(6, Evict(&lru_replacer, pinned));
+  EXPECT_EQ(4, Evict(&lru_replacer, pinned));
+  EXPECT_EQ(-1, Evict(&lru_replacer, pinned));
+}
+
+TEST(LRUReplacerTest, ScanThrashing) {
+  // The workload of the scan resistance tests of the adaptive policies: four hot pages are accessed before every scan
+  // of six new pages. Their reuse distance is longer than the pool, so LRU misses them every time.
+  const size_t num_frames = 8;
+  LRUReplacer lru_replacer(num_frames);
+  ReplacerCache cache(&lru_replacer, num_frames);
+  page_id_t next_page_id = 100;
+  size_t hot_misses = 0;
+  for (int round = 0; round < 50; round++) {
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      if (!cache.Access(page_id) && round >= 5) {
+        hot_misses++;
+      }
+    }
+    for (int i = 0; i < 6; i++) {
+      cache.Access(next_page_id++);
+    }
+  }
+  EXPECT_EQ(4 * 45, hot_misses);
 }
 
 }  // namespace bustub
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable table(10);
+  EXPECT_EQ(32, table.GetCapacity());
+
+  frame_id_t frame_id;
+  EXPECT_FALSE(table.Find(0, frame_id));
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    table.Insert(page_id, static_cast<frame_id_t>(page_id));
+  }
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    EXPECT_TRUE(table.Find(page_id, frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+  EXPECT_FALSE(table.Find(10, frame_id));
+
+  // Insert updates the frame of a page that is already there.
+  table.Insert(3, 7);
+  EXPECT_TRUE(table.Find(3, frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  EXPECT_TRUE(table.Remove(3));
+  EXPECT_FALSE(table.Remove(3));
+  EXPECT_FALSE(table.Find(3, frame_id));
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    if (page_id != 3) {
+      EXPECT_TRUE(table.Find(page_id, frame_id));
+      EXPECT_EQ(page_id, frame_id);
+    }
+  }
+}
+
+TEST(PageTableTest, ChurnTest) {
+  // A buffer pool replacing its pages over and over: the table never holds more than num_frames entries, but sees
+  // many more distinct pages. Removed slots must be reused or the table fills up.
+  const size_t num_frames = 16;
+  PageTable table(num_frames);
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < 10000; page_id++) {
+    if (page_id >= static_cast<page_id_t>(num_frames)) {
+      EXPECT_TRUE(table.Remove(page_id - static_cast<page_id_t>(num_frames)));
+    }
+    table.Insert(page_id, page_id % static_cast<frame_id_t>(num_frames));
+  }
+  for (page_id_t page_id = 10000 - static_cast<page_id_t>(num_frames); page_id < 10000; page_id++) {
+    EXPECT_TRUE(table.Find(page_id, frame_id));
+    EXPECT_EQ(page_id % static_cast<frame_id_t>(num_frames), frame_id);
+  }
+  EXPECT_FALSE(table.Find(0, frame_id));
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Lookups of pages that stay in the table always succeed while other pages come and go around them.
+  const size_t num_frames = 64;
+  const page_id_t num_stable = 32;
+  PageTable table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table.Insert(page_id, static_cast<frame_id_t>(page_id));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&] {
+      frame_id_t frame_id;
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+          ASSERT_TRUE(table.Find(page_id, frame_id));
+          ASSERT_EQ(page_id, frame_id);
+        }
+      }
+    });
+  }
+
+  const page_id_t num_churn = static_cast<page_id_t>(num_frames) - num_stable;
+  for (page_id_t page_id = num_stable; page_id < 20000; page_id++) {
+    if (page_id >= num_stable + num_churn) {
+      table.Remove(page_id - num_churn);
+    }
+    table.Insert(page_id, 0);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+TEST(PageTableTest, GrowTest) {
+  // The table grows while lookups run: the pages that were there all along are found in the old table or the new one.
+  const page_id_t num_stable = 8;
+  PageTable table(num_stable);
+  EXPECT_EQ(16, table.GetCapacity());
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table.Insert(page_id, static_cast<frame_id_t>(page_id));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&] {
+      frame_id_t frame_id;
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+          ASSERT_TRUE(table.Find(page_id, frame_id));
+          ASSERT_EQ(page_id, frame_id);
+        }
+      }
+    });
+  }
+
+  for (size_t num_frames = 16; num_frames <= 4096; num_frames *= 2) {
+    table.Grow(num_frames);
+    for (auto page_id = static_cast<page_id_t>(num_frames / 2); page_id < static_cast<page_id_t>(num_frames);
+         page_id++) {
+      table.Insert(page_id, static_cast<frame_id_t>(page_id));
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(8192, table.GetCapacity());
+  table.Grow(10);
+  EXPECT_EQ(8192, table.GetCapacity());
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < 4096; page_id++) {
+    EXPECT_TRUE(table.Find(page_id, frame_id));
+    EXPECT_EQ(page_id, frame_id);
+  }
+}
+
+}  // namespace bustub
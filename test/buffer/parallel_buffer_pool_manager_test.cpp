@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/util/tasks_util.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Every page id is routed back
+  // to the instance that allocated it.
+  std::set<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(page_ids.insert(page_id_temp).second);
+    EXPECT_EQ(page, bpm->FetchPage(page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning every page, we should be able to create a new page in each instance.
+  for (page_id_t page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(page_ids.insert(page_id_temp).second);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: Deleting an unpinned page frees its frame.
+  EXPECT_TRUE(bpm->DeletePage(0));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentNewAndFetch) {
+  const std::string db_name = "test.db";
+  const size_t pool_size = 10;
+  const size_t num_instances = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager, k);
+
+  std::mutex page_ids_mutex;
+  std::vector<page_id_t> page_ids;
+
+  TasksUtil t(16);
+
+  std::vector<TaskID> deps;
+  deps.push_back(t.addTask(
+      [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+          page_id_t page_id;
+          auto *page = bpm->NewPage(&page_id);
+          ASSERT_NE(nullptr, page);
+          snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello %d", page_id);
+          page_ids_mutex.lock();
+          page_ids.push_back(page_id);
+          page_ids_mutex.unlock();
+          bpm->UnpinPage(page_id, true);
+        }
+      },
+      4, pool_size * num_instances * 4));
+
+  t.addTaskWithDeps(
+      [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+          page_id_t page_id = page_ids[i];
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(page_id, page->GetPageId());
+          char str[BUSTUB_PAGE_SIZE];
+          snprintf(str, BUSTUB_PAGE_SIZE, "Hello %d", page_id);
+          EXPECT_EQ(0, strcmp(page->GetData(), str));
+          bpm->UnpinPage(page_id, false);
+        }
+      },
+      4, pool_size * num_instances * 4, deps);
+
+  t.run();
+
+  std::set<page_id_t> unique_page_ids(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(page_ids.size(), unique_page_ids.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, Resize) {
+  const size_t num_instances = 3;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, 4, disk_manager, k);
+
+  // The frames are spread evenly, the first instances get the remainder.
+  EXPECT_TRUE(bpm->Resize(20));
+  EXPECT_EQ(20, bpm->GetPoolSize());
+  EXPECT_EQ(7, bpm->GetBufferPoolManager(0)->GetPoolSize());
+  EXPECT_EQ(7, bpm->GetBufferPoolManager(1)->GetPoolSize());
+  EXPECT_EQ(6, bpm->GetBufferPoolManager(2)->GetPoolSize());
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 20; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Every instance keeps at least one frame.
+  EXPECT_FALSE(bpm->Resize(2));
+  EXPECT_TRUE(bpm->Resize(3));
+  EXPECT_EQ(3, bpm->GetPoolSize());
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, Segments) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(4, 4, disk_manager);
+  auto new_pages = [&](page_id_t segment, int num_pages, std::set<page_id_t> *extents) {
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id, segment));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      extents->insert(page_id / EXTENT_SIZE);
+    }
+  };
+
+  // The instances allocate from the stripes of the same extents, a table of two extents worth of pages fills two.
+  page_id_t table;
+  std::set<page_id_t> table_extents;
+  ASSERT_NE(nullptr, bpm->NewPage(&table, NEW_SEGMENT));
+  EXPECT_TRUE(bpm->UnpinPage(table, true));
+  new_pages(table, 2 * EXTENT_SIZE - 1, &table_extents);
+  EXPECT_EQ((std::set<page_id_t>{0, 1}), table_extents);
+
+  // Scenario: two tables growing at the same time never share an extent.
+  page_id_t other_table;
+  std::set<page_id_t> other_table_extents;
+  ASSERT_NE(nullptr, bpm->NewPage(&other_table, NEW_SEGMENT));
+  EXPECT_TRUE(bpm->UnpinPage(other_table, true));
+  for (int i = 0; i < EXTENT_SIZE; i++) {
+    new_pages(table, 1, &table_extents);
+    new_pages(other_table, 1, &other_table_extents);
+  }
+  for (page_id_t extent : other_table_extents) {
+    EXPECT_EQ(0, table_extents.count(extent));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
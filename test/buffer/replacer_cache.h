@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_cache.h
+//
+// Identification: test/buffer/replacer_cache.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/**
+ * ReplacerCache drives a replacer the way the buffer pool manager does, with page ids standing in for pages: a hit
+ * records an access, a miss takes a free frame or evicts the victim, then admits the page.
+ */
+class ReplacerCache {
+ public:
+  ReplacerCache(Replacer *replacer, size_t num_frames) : replacer_(replacer), pages_(num_frames, INVALID_PAGE_ID) {
+    replacer_->SetPoolSize(num_frames);
+    for (size_t i = num_frames; i > 0; i--) {
+      free_frames_.push_back(static_cast<frame_id_t>(i - 1));
+    }
+  }
+
+  /**
+   * Access a page, evicting an unpinned one if it is not resident.
+   * @return true on a hit
+   */
+  auto Access(page_id_t page_id) -> bool {
+    auto it = frames_.find(page_id);
+    if (it != frames_.end()) {
+      replacer_->RecordAccess(it->second);
+      return true;
+    }
+    frame_id_t frame_id;
+    if (!free_frames_.empty()) {
+      frame_id = free_frames_.back();
+      free_frames_.pop_back();
+    } else {
+      frame_id = replacer_->Victim([this](frame_id_t frame_id) { return pinned_.count(pages_[frame_id]) == 0; });
+      EXPECT_NE(-1, frame_id);
+      EXPECT_EQ(0, pinned_.count(pages_[frame_id]));
+      replacer_->Remove(frame_id, true);
+      frames_.erase(pages_[frame_id]);
+    }
+    pages_[frame_id] = page_id;
+    frames_[page_id] = frame_id;
+    replacer_->Admit(frame_id, page_id);
+    return false;
+  }
+
+  auto IsResident(page_id_t page_id) const -> bool { return frames_.count(page_id) != 0; }
+
+  /** Pages that must not be evicted. */
+  std::set<page_id_t> pinned_;
+
+ private:
+  Replacer *replacer_;
+  std::vector<page_id_t> pages_;
+  std::unordered_map<page_id_t, frame_id_t> frames_;
+  std::vector<frame_id_t> free_frames_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include "gtest/gtest.h"
+#include "replacer_cache.h"
+
+namespace bustub {
+
+namespace {
+
+/** Evict like the buffer pool does: pick the victim, then stop tracking it. */
+auto Evict(Replacer *replacer) -> frame_id_t {
+  frame_id_t frame_id = replacer->Victim([](frame_id_t frame_id) { return true; });
+  if (frame_id != -1) {
+    replacer->Remove(frame_id, true);
+  }
+  return frame_id;
+}
+
+}  // namespace
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // A1in holds one page, A1out two.
+  TwoQueueReplacer two_queue_replacer(4);
+
+  // Scenario: fill the pool. Hits do not move pages in A1in, it is evicted in FIFO order.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_queue_replacer.Admit(frame_id, frame_id);
+  }
+  two_queue_replacer.RecordAccess(0);
+  EXPECT_EQ(0, Evict(&two_queue_replacer));
+  two_queue_replacer.Admit(0, 4);
+  EXPECT_EQ(1, Evict(&two_queue_replacer));
+
+  // Scenario: page 0 is missed again while in A1out. It goes to Am, in frame 1.
+  two_queue_replacer.Admit(1, 0);
+  EXPECT_EQ(2, Evict(&two_queue_replacer));
+  two_queue_replacer.Admit(2, 5);
+  EXPECT_EQ(3, Evict(&two_queue_replacer));
+
+  // Scenario: page 1 was pushed out of A1out by pages 2 and 3, it goes back to A1in.
+  two_queue_replacer.Admit(3, 1);
+
+  // Scenario: A1in is drained down to its size, then Am is evicted before A1in.
+  EXPECT_EQ(0, Evict(&two_queue_replacer));
+  EXPECT_EQ(2, Evict(&two_queue_replacer));
+  EXPECT_EQ(1, Evict(&two_queue_replacer));
+  EXPECT_EQ(3, Evict(&two_queue_replacer));
+  EXPECT_EQ(-1, Evict(&two_queue_replacer));
+}
+
+TEST(TwoQueueReplacerTest, ScanResistance) {
+  // Four hot pages are accessed before every scan of six new pages. Their reuse distance is longer than the pool, so
+  // LRU misses them every time. 2Q finds them in A1out, and keeps them in Am from then on.
+  const size_t num_frames = 8;
+  TwoQueueReplacer two_queue_replacer(num_frames);
+  ReplacerCache cache(&two_queue_replacer, num_frames);
+  page_id_t next_page_id = 100;
+  size_t hot_misses = 0;
+  for (int round = 0; round < 50; round++) {
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+      if (!cache.Access(page_id) && round >= 5) {
+        hot_misses++;
+      }
+    }
+    for (int i = 0; i < 6; i++) {
+      cache.Access(next_page_id++);
+    }
+  }
+  EXPECT_EQ(0, hot_misses);
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -64,6 +65,69 @@ TEST(BPlusTreeTests, InsertTest1) {
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, BatchLookupTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  remove("test.db");
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  (void)header_page;
+
+  // Even keys only, over several levels of small nodes.
+  for (int64_t key = 0; key < 200; key += 2) {
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<int>(key & 0xFFFFFFFF));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // Present and missing keys, out of order, one of them twice.
+  std::vector<int64_t> probes = {150, 3, 0, 198, 42, 199, 42, 77, 100};
+  std::vector<GenericKey<8>> keys(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    keys[i].SetFromInteger(probes[i]);
+  }
+  std::vector<int> pin_counts;
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    pin_counts.push_back(bpm->GetFrames()[i].GetPinCount());
+  }
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(keys, &results, transaction);
+  ASSERT_EQ(probes.size(), results.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    if (probes[i] % 2 != 0) {
+      EXPECT_TRUE(results[i].empty());
+      continue;
+    }
+    ASSERT_EQ(1, results[i].size());
+    EXPECT_EQ(probes[i], results[i][0].GetSlotNum());
+  }
+
+  // Every node fetched by the batch has been unpinned.
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    EXPECT_EQ(pin_counts[i], bpm->GetFrames()[i].GetPinCount());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -55,6 +60,229 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  char buf[3 * BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  for (page_id_t page_id = 0; page_id < 2; page_id++) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  // The third page is past the end of the file and reads as zeros.
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPages(0, 3, buf);
+  EXPECT_STREQ("page 0", buf);
+  EXPECT_STREQ("page 1", buf + BUSTUB_PAGE_SIZE);
+  for (size_t i = 2 * BUSTUB_PAGE_SIZE; i < sizeof(buf); i++) {
+    ASSERT_EQ(0, buf[i]);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesAcrossGroupsTest) {
+  // Every group of BUSTUB_PAGE_SIZE * 8 pages starts with its space map page, a read of pages on both sides of a
+  // group boundary skips it.
+  const auto last = static_cast<page_id_t>(BUSTUB_PAGE_SIZE * 8 - 1);
+  char buf[2 * BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  for (page_id_t page_id = last; page_id <= last + 1; page_id++) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+  dm.ReadPages(last, 2, buf);
+  EXPECT_EQ("page " + std::to_string(last), std::string(buf));
+  EXPECT_EQ("page " + std::to_string(last + 1), std::string(buf + BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  // Four pages written from separate buffers, across the space map page between the first two groups.
+  const auto first = static_cast<page_id_t>(BUSTUB_PAGE_SIZE * 8 - 2);
+  std::vector<std::vector<char>> data(4, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<const char *> page_data;
+  for (page_id_t i = 0; i < 4; i++) {
+    snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %d", first + i);
+    page_data.push_back(data[i].data());
+  }
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  dm.WritePages(first, page_data.size(), page_data.data());
+  dm.SyncPages();
+  EXPECT_EQ(4, dm.GetNumWrites());
+  for (page_id_t i = 0; i < 4; i++) {
+    dm.ReadPage(first + i, buf);
+    EXPECT_EQ("page " + std::to_string(first + i), std::string(buf));
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: every thread writes, then reads back, its own pages while the others do the same.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + t;
+        snprintf(data, sizeof(data), "page %d", page_id);
+        dm.WritePage(page_id, data);
+      }
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + t;
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  // Scenario: a page past the end of the file reads as zeros.
+  char buf[BUSTUB_PAGE_SIZE];
+  memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_threads * pages_per_thread, buf);
+  EXPECT_EQ(0, memcmp(buf, std::string(BUSTUB_PAGE_SIZE, '\0').data(), BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file);
+
+  // Scenario: pages are allocated in order, a deallocated page is the next one handed out.
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  dm->DeallocatePage(1);
+  dm->DeallocatePage(3);
+  EXPECT_FALSE(dm->IsAllocated(1));
+  EXPECT_EQ(1, dm->AllocatePage());
+
+  // Scenario: a stripe only hands out its own page ids, and sees the pages the other stripes allocated.
+  EXPECT_EQ(3, dm->AllocatePage(2, 1));
+  EXPECT_EQ(6, dm->AllocatePage(2, 0));
+  EXPECT_EQ(5, dm->AllocatePage(2, 1));
+  dm->DeallocatePage(2);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: the allocations survive a restart.
+  dm = new DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    EXPECT_EQ(page_id != 2 && page_id != 7, dm->IsAllocated(page_id));
+  }
+  EXPECT_EQ(2, dm->AllocatePage());
+  EXPECT_EQ(7, dm->AllocatePage());
+  EXPECT_EQ(8, dm->AllocatePage());
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file);
+
+  // Every segment starts in an extent of its own, pages of no segment stay out of them.
+  EXPECT_EQ(0, dm->AllocatePage());
+  const page_id_t table = dm->AllocatePage(1, 0, NEW_SEGMENT);
+  const page_id_t index = dm->AllocatePage(1, 0, NEW_SEGMENT);
+  EXPECT_EQ(EXTENT_SIZE, table);
+  EXPECT_EQ(2 * EXTENT_SIZE, index);
+  EXPECT_EQ(table + 1, dm->AllocatePage(1, 0, table));
+  EXPECT_EQ(index + 1, dm->AllocatePage(1, 0, index));
+  EXPECT_EQ(1, dm->AllocatePage());
+
+  // Scenario: a segment is named by any of its pages, and takes a new extent once it filled its first one.
+  for (page_id_t page_id = table + 2; page_id < table + EXTENT_SIZE; page_id++) {
+    EXPECT_EQ(page_id, dm->AllocatePage(1, 0, page_id - 1));
+  }
+  EXPECT_EQ(3 * EXTENT_SIZE, dm->AllocatePage(1, 0, table + 1));
+  for (page_id_t page_id = 2; page_id < EXTENT_SIZE; page_id++) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  EXPECT_EQ(4 * EXTENT_SIZE, dm->AllocatePage());
+
+  // Scenario: a page freed in a segment is reused by the segment only.
+  dm->DeallocatePage(table + 10);
+  EXPECT_EQ(4 * EXTENT_SIZE + 1, dm->AllocatePage());
+  EXPECT_EQ(table + 10, dm->AllocatePage(1, 0, 3 * EXTENT_SIZE));
+
+  // Scenario: stripes of a parallel buffer pool share the extents of a segment.
+  const page_id_t striped = dm->AllocatePage(2, 1, NEW_SEGMENT);
+  EXPECT_EQ(5 * EXTENT_SIZE + 1, striped);
+  EXPECT_EQ(5 * EXTENT_SIZE, dm->AllocatePage(2, 0, striped));
+  EXPECT_EQ(5 * EXTENT_SIZE + 3, dm->AllocatePage(2, 1, striped));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: after a restart, the extent of the page naming a segment is the segment's first extent again.
+  dm = new DiskManager(db_file);
+  EXPECT_EQ(index + 2, dm->AllocatePage(1, 0, index));
+  EXPECT_EQ(6 * EXTENT_SIZE, dm->AllocatePage(1, 0, table));
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file, true);
+  // A buffer aligned like the frames of the buffer pool, and one that is not.
+  auto *aligned = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+  std::vector<char> buf(BUSTUB_PAGE_SIZE + 1);
+  char *unaligned = buf.data() + 1;
+
+  EXPECT_EQ(0, dm->AllocatePage());
+  std::memset(aligned, 0, BUSTUB_PAGE_SIZE);
+  std::strncpy(aligned, "aligned", BUSTUB_PAGE_SIZE);
+  dm->WritePage(0, aligned);
+  std::memset(unaligned, 0, BUSTUB_PAGE_SIZE);
+  std::strncpy(unaligned, "unaligned", BUSTUB_PAGE_SIZE);
+  dm->WritePage(1, unaligned);
+
+  dm->ReadPage(0, unaligned);
+  EXPECT_STREQ("aligned", unaligned);
+  dm->ReadPage(1, aligned);
+  EXPECT_STREQ("unaligned", aligned);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: a buffered disk manager finds the pages and the space map in the file.
+  dm = new DiskManager(db_file);
+  EXPECT_FALSE(dm->IsDirectIo());
+  EXPECT_TRUE(dm->IsAllocated(0));
+  dm->ReadPage(1, unaligned);
+  EXPECT_STREQ("unaligned", unaligned);
+  dm->ShutDown();
+  delete dm;
+  std::free(aligned);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
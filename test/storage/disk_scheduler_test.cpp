@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+namespace {
+
+/** Write num_pages pages, each one holding its id, then read them back, with all the requests of a pass in flight. */
+void WriteAndReadBack(DiskScheduler *scheduler, page_id_t num_pages) {
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<bool>> futures;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    snprintf(data[page_id].data(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    auto promise = scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    scheduler->Schedule({true, data[page_id].data(), page_id, std::move(promise)});
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+
+  std::vector<std::vector<char>> buf(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE, 1));
+  futures.clear();
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto promise = scheduler->CreatePromise();
+    futures.push_back(promise.get_future());
+    scheduler->Schedule({false, buf[page_id].data(), page_id, std::move(promise)});
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    EXPECT_TRUE(futures[page_id].get());
+    EXPECT_EQ(0, memcmp(data[page_id].data(), buf[page_id].data(), BUSTUB_PAGE_SIZE));
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleTest) {
+  remove("test.db");
+  auto *dm = new DiskManager("test.db");
+  const page_id_t num_pages = 100;
+  {
+    // Fewer entries than requests, so that some wait for a slot.
+    DiskScheduler scheduler(dm, 16);
+    WriteAndReadBack(&scheduler, num_pages);
+
+    // Scenario: a page past the end of the file reads as zeros.
+    std::vector<char> buf(BUSTUB_PAGE_SIZE, 1);
+    auto promise = scheduler.CreatePromise();
+    auto future = promise.get_future();
+    scheduler.Schedule({false, buf.data(), num_pages + 10, std::move(promise)});
+    EXPECT_TRUE(future.get());
+    EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), buf);
+  }
+  EXPECT_EQ(num_pages, dm->GetNumWrites());
+
+  // Scenario: the writes went to the file.
+  char buf[BUSTUB_PAGE_SIZE];
+  dm->ReadPage(42, buf);
+  EXPECT_STREQ("page 42", buf);
+
+  dm->ShutDown();
+  delete dm;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, WorkerThreadsTest) {
+  // A disk manager without a file goes through the worker threads.
+  auto *dm = new DiskManagerUnlimitedMemory();
+  {
+    DiskScheduler scheduler(dm);
+    EXPECT_FALSE(scheduler.UsesIoUring());
+    WriteAndReadBack(&scheduler, 100);
+  }
+  delete dm;
+}
+
+}  // namespace bustub
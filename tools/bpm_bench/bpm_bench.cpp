@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct BpmBenchConfig {
+  size_t pool_size_{1024};
+  size_t num_instances_{8};
+  size_t num_pages_{1024};
+  size_t max_threads_{8};
+  uint64_t duration_ms_{2000};
+};
+
+/**
+ * Create `num_pages` pages in the buffer pool, each one stamped with its page id, and leave them unpinned.
+ */
+auto PreparePages(bustub::BufferPoolManager *bpm, size_t num_pages) -> std::vector<bustub::page_id_t> {
+  std::vector<bustub::page_id_t> page_ids;
+  page_ids.reserve(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      throw bustub::Exception("cannot allocate page");
+    }
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  return page_ids;
+}
+
+/**
+ * Fetch random pages from `num_threads` threads for the configured duration.
+ * @return the number of FetchPage calls per second over all threads
+ */
+auto RunFetch(bustub::BufferPoolManager *bpm, const std::vector<bustub::page_id_t> &page_ids, size_t num_threads,
+              uint64_t duration_ms) -> double {
+  std::atomic<uint64_t> total_fetches{0};
+  std::vector<std::thread> threads;
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937_64 rng(thread_id);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      uint64_t fetches = 0;
+      while (ClockMs() - start < duration_ms) {
+        for (size_t i = 0; i < 64; i++) {
+          auto page_id = page_ids[dist(rng)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->RLatch();
+          bustub::page_id_t stamp;
+          memcpy(&stamp, page->GetData(), sizeof(stamp));
+          page->RUnlatch();
+          if (stamp != page_id) {
+            throw bustub::Exception(fmt::format("page {} holds data of page {}", page_id, stamp));
+          }
+          bpm->UnpinPage(page_id, false);
+          fetches++;
+        }
+      }
+      total_fetches += fetches;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+  return static_cast<double>(total_fetches) / static_cast<double>(elapsed) * 1000;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--pool-size").help("total number of frames in the buffer pool");
+  program.add_argument("--instances").help("number of instances of the parallel buffer pool manager");
+  program.add_argument("--pages").help("number of distinct pages fetched by the benchmark");
+  program.add_argument("--threads").help("maximum number of threads, doubled from 1 up to this number");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  BpmBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoi(program.get("--duration"));
+  }
+  if (program.present("--pool-size")) {
+    config.pool_size_ = std::stoi(program.get("--pool-size"));
+  }
+  if (program.present("--instances")) {
+    config.num_instances_ = std::stoi(program.get("--instances"));
+  }
+  if (program.present("--pages")) {
+    config.num_pages_ = std::stoi(program.get("--pages"));
+  }
+  if (program.present("--threads")) {
+    config.max_threads_ = std::stoi(program.get("--threads"));
+  }
+
+  std::cerr << fmt::format("x: pool_size={} instances={} pages={} duration={}ms", config.pool_size_,
+                           config.num_instances_, config.num_pages_, config.duration_ms_)
+            << std::endl;
+
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto single = std::make_unique<bustub::BufferPoolManagerInstance>(config.pool_size_, disk_manager.get());
+  auto single_page_ids = PreparePages(single.get(), config.num_pages_);
+
+  auto parallel_disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto parallel = std::make_unique<bustub::ParallelBufferPoolManager>(
+      config.num_instances_, config.pool_size_ / config.num_instances_, parallel_disk_manager.get());
+  auto parallel_page_ids = PreparePages(parallel.get(), config.num_pages_);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("{:>8} {:>16} {:>16}\n", "threads", "instance(op/s)", "parallel(op/s)");
+  for (size_t num_threads = 1; num_threads <= config.max_threads_; num_threads *= 2) {
+    auto single_ops = RunFetch(single.get(), single_page_ids, num_threads, config.duration_ms_);
+    auto parallel_ops = RunFetch(parallel.get(), parallel_page_ids, num_threads, config.duration_ms_);
+    fmt::print("{:>8} {:>16.0f} {:>16.0f}\n", num_threads, single_ops, parallel_ops);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+struct DiskBenchConfig {
+  size_t pool_size_{4096};
+  size_t num_pages_{65536};
+  size_t num_threads_{4};
+  uint64_t duration_ms_{5000};
+  std::string db_file_{"disk-bench.db"};
+  bool sequential_{false};
+};
+
+/** A way for the disk manager to do its I/O, one row of the results. */
+struct DiskMode {
+  std::string name_;
+  std::function<std::unique_ptr<bustub::DiskManager>(const std::string &db_file)> create_;
+};
+
+/**
+ * Create the database file: `num_pages` pages, each one stamped with its page id.
+ */
+void CreateDatabase(const DiskBenchConfig &config) {
+  remove(config.db_file_.c_str());
+  bustub::DiskManager disk_manager(config.db_file_);
+  bustub::BufferPoolManagerInstance bpm(config.pool_size_, &disk_manager);
+  for (size_t i = 0; i < config.num_pages_; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm.NewPage(&page_id);
+    if (page == nullptr) {
+      throw bustub::Exception("cannot allocate page");
+    }
+    memcpy(page->GetData(), &page_id, sizeof(page_id));
+    bpm.UnpinPage(page_id, true);
+  }
+  bpm.FlushAllPages();
+  disk_manager.ShutDown();
+}
+
+/**
+ * Write the file back and drop it from the OS page cache, so that every mode starts cold.
+ */
+void DropFromPageCache(const std::string &file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/** @return the bytes of the file in the OS page cache */
+auto PageCacheBytes(const std::string &file) -> size_t {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return 0;
+  }
+  size_t size = lseek(fd, 0, SEEK_END);
+  void *mapping = size == 0 ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return 0;
+  }
+  const auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> resident((size + os_page_size - 1) / os_page_size);
+  size_t cached = 0;
+  if (mincore(mapping, size, resident.data()) == 0) {
+    for (unsigned char page : resident) {
+      cached += (page & 1) * os_page_size;
+    }
+  }
+  munmap(mapping, size);
+  return cached;
+}
+
+/** @return the resident set size of the process, in bytes */
+auto ResidentBytes() -> size_t {
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0;
+  size_t resident = 0;
+  statm >> size >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Fetch pages from the configured number of threads for the configured duration: random ones, or for a sequential
+ * run, every page in order from a different starting point per thread.
+ * @return the number of FetchPage calls per second over all threads
+ */
+auto RunFetch(bustub::BufferPoolManager *bpm, const DiskBenchConfig &config) -> double {
+  std::atomic<uint64_t> total_fetches{0};
+  std::vector<std::thread> threads;
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < config.num_threads_; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937_64 rng(thread_id);
+      std::uniform_int_distribution<bustub::page_id_t> dist(0, static_cast<bustub::page_id_t>(config.num_pages_) - 1);
+      uint64_t fetches = 0;
+      auto next_page_id = dist(rng);
+      while (ClockMs() - start < config.duration_ms_) {
+        for (size_t i = 0; i < 64; i++) {
+          auto page_id = dist(rng);
+          if (config.sequential_) {
+            page_id = next_page_id;
+            next_page_id = (next_page_id + 1) % static_cast<bustub::page_id_t>(config.num_pages_);
+          }
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->RLatch();
+          bustub::page_id_t stamp;
+          memcpy(&stamp, page->GetData(), sizeof(stamp));
+          page->RUnlatch();
+          if (stamp != page_id) {
+            throw bustub::Exception(fmt::format("page {} holds data of page {}", page_id, stamp));
+          }
+          bpm->UnpinPage(page_id, false);
+          fetches++;
+        }
+      }
+      total_fetches += fetches;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+  return static_cast<double>(total_fetches) / static_cast<double>(elapsed) * 1000;
+}
+
+/**
+ * Dirty a pool worth of consecutive pages, then flush them all, like a checkpoint does.
+ * @return the time FlushAllPages() took, in milliseconds
+ */
+auto RunFlush(bustub::BufferPoolManager *bpm, const DiskBenchConfig &config) -> uint64_t {
+  auto num_pages = static_cast<bustub::page_id_t>(std::min(config.pool_size_, config.num_pages_));
+  for (bustub::page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    if (page == nullptr) {
+      throw bustub::Exception("cannot fetch page");
+    }
+    bpm->UnpinPage(page_id, true);
+  }
+  auto start = ClockMs();
+  bpm->FlushAllPages();
+  return ClockMs() - start;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--duration").help("run each mode for n milliseconds");
+  program.add_argument("--pool-size").help("number of frames in the buffer pool");
+  program.add_argument("--pages").help("number of pages in the database file, make it larger than the OS page cache");
+  program.add_argument("--threads").help("number of threads fetching pages");
+  program.add_argument("--db-file").help("database file, created and removed by the benchmark");
+  program.add_argument("--sequential")
+      .help("fetch the pages in order instead of at random")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  DiskBenchConfig config;
+  if (program.present("--duration")) {
+    config.duration_ms_ = std::stoi(program.get("--duration"));
+  }
+  if (program.present("--pool-size")) {
+    config.pool_size_ = std::stoi(program.get("--pool-size"));
+  }
+  if (program.present("--pages")) {
+    config.num_pages_ = std::stoi(program.get("--pages"));
+  }
+  if (program.present("--threads")) {
+    config.num_threads_ = std::stoi(program.get("--threads"));
+  }
+  if (program.present("--db-file")) {
+    config.db_file_ = program.get("--db-file");
+  }
+  config.sequential_ = program.get<bool>("--sequential");
+
+  std::cerr << fmt::format("x: pool_size={} pages={} threads={} duration={}ms sequential={}", config.pool_size_,
+                           config.num_pages_, config.num_threads_, config.duration_ms_, config.sequential_)
+            << std::endl;
+
+  auto access_pattern = config.sequential_ ? bustub::AccessPattern::SEQUENTIAL : bustub::AccessPattern::RANDOM;
+
+  std::vector<DiskMode> modes = {
+      {"buffered", [](const std::string &db_file) { return std::make_unique<bustub::DiskManager>(db_file); }},
+      {"direct", [](const std::string &db_file) { return std::make_unique<bustub::DiskManager>(db_file, true); }},
+      {"mmap",
+       [&](const std::string &db_file) { return std::make_unique<bustub::DiskManagerMmap>(db_file, access_pattern); }},
+  };
+
+  CreateDatabase(config);
+  fmt::print("<<< BEGIN\n");
+  fmt::print("{:>10} {:>12} {:>10} {:>12} {:>16} {:>10}\n", "mode", "fetch(op/s)", "hit_ratio", "rss(MB)",
+             "page_cache(MB)", "flush(ms)");
+  for (auto &mode : modes) {
+    DropFromPageCache(config.db_file_);
+    auto disk_manager = mode.create_(config.db_file_);
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(config.pool_size_, disk_manager.get());
+    auto ops = RunFetch(bpm.get(), config);
+    auto stats = bpm->GetStats();
+    auto rss = ResidentBytes();
+    auto page_cache = PageCacheBytes(config.db_file_);
+    auto flush_ms = RunFlush(bpm.get(), config);
+    fmt::print("{:>10} {:>12.0f} {:>10.4f} {:>12.1f} {:>16.1f} {:>10}\n", mode.name_, ops, stats.HitRatio(),
+               static_cast<double>(rss) / (1 << 20), static_cast<double>(page_cache) / (1 << 20), flush_ms);
+    bpm.reset();
+    disk_manager->ShutDown();
+  }
+  fmt::print(">>> END\n");
+
+  remove(config.db_file_.c_str());
+  remove(config.db_file_.substr(0, config.db_file_.rfind('.')).append(".log").c_str());
+  return 0;
+}
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/replacer.h"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+struct ReplacerBenchConfig {
+  size_t pool_size_{1024};
+  size_t num_pages_{8192};
+  size_t num_accesses_{200000};
+  size_t replacer_k_{bustub::LRUK_REPLACER_K};
+};
+
+/** A page access trace: the page ids in the order they are fetched. */
+struct Trace {
+  std::string name_;
+  std::vector<bustub::page_id_t> page_ids_;
+};
+
+/**
+ * A disk that stores nothing and counts the page reads, i.e. the misses of the buffer pool.
+ */
+class MissCountingDiskManager : public bustub::DiskManager {
+ public:
+  void WritePage(bustub::page_id_t page_id, const char *page_data) override {}
+
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    memset(page_data, 0, bustub::BUSTUB_PAGE_SIZE);
+    reads_++;
+  }
+
+  void ReadPages(bustub::page_id_t first_page_id, size_t num_pages, char *page_data) override {
+    memset(page_data, 0, num_pages * bustub::BUSTUB_PAGE_SIZE);
+    reads_ += num_pages;
+  }
+
+  std::atomic<size_t> reads_{0};
+};
+
+/**
+ * Load a recorded trace: page ids separated by white space, `#` starts a comment that runs to the end of the line.
+ */
+auto LoadTrace(const std::string &path) -> Trace {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    throw bustub::Exception(fmt::format("cannot open trace {}", path));
+  }
+  Trace trace{path.substr(path.find_last_of('/') + 1), {}};
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream words(line.substr(0, line.find('#')));
+    bustub::page_id_t page_id;
+    while (words >> page_id) {
+      if (page_id < 0) {
+        throw bustub::Exception(fmt::format("negative page id in trace {}", path));
+      }
+      trace.page_ids_.push_back(page_id);
+    }
+    if (!words.eof()) {
+      throw bustub::Exception(fmt::format("bad page id in trace {}", path));
+    }
+  }
+  return trace;
+}
+
+/** Skewed accesses: page i is picked with a probability proportional to 1 / (i + 1)^0.99. */
+auto ZipfTrace(const ReplacerBenchConfig &config) -> Trace {
+  std::vector<double> cdf(config.num_pages_);
+  double sum = 0;
+  for (size_t i = 0; i < config.num_pages_; i++) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+    cdf[i] = sum;
+  }
+  std::mt19937_64 rng(0);
+  std::uniform_real_distribution<double> dist(0, sum);
+  Trace trace{"zipf", {}};
+  for (size_t i = 0; i < config.num_accesses_; i++) {
+    auto page = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    trace.page_ids_.push_back(static_cast<bustub::page_id_t>(page));
+  }
+  return trace;
+}
+
+/**
+ * An OLTP-like working set of half the pool, with a sequential scan of twice the pool over cold pages after every
+ * pool-sized batch of random accesses.
+ */
+auto ScanTrace(const ReplacerBenchConfig &config) -> Trace {
+  const size_t hot_pages = std::max<size_t>(1, config.pool_size_ / 2);
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<size_t> hot(0, hot_pages - 1);
+  Trace trace{"hot+scan", {}};
+  size_t next_cold = hot_pages;
+  while (trace.page_ids_.size() < config.num_accesses_) {
+    for (size_t i = 0; i < config.pool_size_; i++) {
+      trace.page_ids_.push_back(static_cast<bustub::page_id_t>(hot(rng)));
+    }
+    for (size_t i = 0; i < 2 * config.pool_size_; i++) {
+      trace.page_ids_.push_back(static_cast<bustub::page_id_t>(next_cold));
+      next_cold = next_cold + 1 < std::max(config.num_pages_, hot_pages + 1) ? next_cold + 1 : hot_pages;
+    }
+  }
+  trace.page_ids_.resize(config.num_accesses_);
+  return trace;
+}
+
+/** A loop over a quarter more pages than the pool holds, which LRU misses every time. */
+auto LoopTrace(const ReplacerBenchConfig &config) -> Trace {
+  const size_t loop_pages = config.pool_size_ + config.pool_size_ / 4 + 1;
+  Trace trace{"loop", {}};
+  for (size_t i = 0; i < config.num_accesses_; i++) {
+    trace.page_ids_.push_back(static_cast<bustub::page_id_t>(i % loop_pages));
+  }
+  return trace;
+}
+
+/**
+ * Replay a trace through a buffer pool with the given policy, one fetch and unpin per access.
+ * @return the hit ratio
+ */
+auto Replay(const Trace &trace, bustub::ReplacerType type, const ReplacerBenchConfig &config) -> double {
+  MissCountingDiskManager disk_manager;
+  bustub::BufferPoolManagerInstance bpm(config.pool_size_, &disk_manager, config.replacer_k_, nullptr, type);
+  for (bustub::page_id_t page_id : trace.page_ids_) {
+    if (bpm.FetchPage(page_id) == nullptr) {
+      throw bustub::Exception(fmt::format("cannot fetch page {}", page_id));
+    }
+    bpm.UnpinPage(page_id, false);
+  }
+  if (trace.page_ids_.empty()) {
+    return 0;
+  }
+  return 1 - static_cast<double>(disk_manager.reads_) / static_cast<double>(trace.page_ids_.size());
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("traces").help("recorded page access traces, synthetic ones if none").remaining();
+  program.add_argument("--pool-size").help("number of frames in the buffer pool");
+  program.add_argument("--pages").help("number of distinct pages of the synthetic traces");
+  program.add_argument("--accesses").help("number of accesses of the synthetic traces");
+  program.add_argument("--k").help("lookback constant of the LRU-K replacer");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  ReplacerBenchConfig config;
+  if (program.present("--pool-size")) {
+    config.pool_size_ = std::stoi(program.get("--pool-size"));
+  }
+  if (program.present("--pages")) {
+    config.num_pages_ = std::stoi(program.get("--pages"));
+  }
+  if (program.present("--accesses")) {
+    config.num_accesses_ = std::stoi(program.get("--accesses"));
+  }
+  if (program.present("--k")) {
+    config.replacer_k_ = std::stoi(program.get("--k"));
+  }
+
+  std::vector<Trace> traces;
+  if (auto paths = program.present<std::vector<std::string>>("traces")) {
+    for (auto &path : *paths) {
+      traces.push_back(LoadTrace(path));
+    }
+  } else {
+    traces.push_back(ZipfTrace(config));
+    traces.push_back(ScanTrace(config));
+    traces.push_back(LoopTrace(config));
+  }
+
+  const std::vector<bustub::ReplacerType> types{bustub::ReplacerType::LRU_K, bustub::ReplacerType::LRU,
+                                                bustub::ReplacerType::CLOCK, bustub::ReplacerType::ARC,
+                                                bustub::ReplacerType::TWO_QUEUE, bustub::ReplacerType::CLOCK_PRO};
+
+  std::cerr << fmt::format("x: pool_size={} k={}", config.pool_size_, config.replacer_k_) << std::endl;
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("{:>16} {:>10}", "trace", "accesses");
+  for (auto type : types) {
+    fmt::print(" {:>10}", bustub::ReplacerTypeToString(type));
+  }
+  fmt::print("\n");
+  for (auto &trace : traces) {
+    fmt::print("{:>16} {:>10}", trace.name_, trace.page_ids_.size());
+    for (auto type : types) {
+      fmt::print(" {:>10.4f}", Replay(trace, type, config));
+    }
+    fmt::print("\n");
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}